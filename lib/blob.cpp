@@ -71,7 +71,10 @@ Blob::Blob():
     m_valid(false),
     m_xOffset(0),
     m_yOffset(0),
-    m_pPoints(0)
+    m_pPoints(0),
+    m_pChildContours(0),
+    m_pChildIndexes(0),
+    m_childCount(0)
 {
 }//Blob bool
 
@@ -121,7 +124,47 @@ void Blob::clearPointVector()
  * \param _contour Input Contour.
  * \param _children Input _contour children.
  */
-void Blob::update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, ContourVector & _children)
+void Blob::update(const Mat & _mat, const Rect & _boundingRect, const Contour & _contour, const ContourVector & _children)
+{
+    m_contour = _contour;
+    m_children = _children;
+
+    traverse(_mat,_boundingRect);
+}//update
+
+//-------------------------
+
+/*!
+ * \brief Blob::update Same as above, with contours kept in a ContourStore, as found by ContourManager.
+ *        Children are read in place, m_children is left empty.
+ * \param _mat Input image.
+ * \param _boundingRect Input Rect.
+ * \param _contours Input contours.
+ * \param _childTable Input children of each contour.
+ * \param _index Blob contour index in _contours.
+ */
+void Blob::update(const Mat & _mat, const Rect & _boundingRect, const ContourStore & _contours, const ChildIndexTable & _childTable, int _index)
+{
+    _contours.contour(_index,m_contour);
+    m_children.clear();
+
+    m_pChildContours = &_contours;
+    m_pChildIndexes = _childTable.children(_index);
+    m_childCount = _childTable.childCount(_index);
+
+    traverse(_mat,_boundingRect);
+
+    m_pChildContours = 0;
+    m_pChildIndexes = 0;
+    m_childCount = 0;
+}//update ContourStore
+
+//-------------------------
+
+/*!
+ * \brief Blob::traverse Loops through all pixels of _boundingRect with current contour and children.
+ */
+void Blob::traverse(const Mat & _mat, const Rect & _boundingRect)
 {
     //Can we retrieve blob attributes?
     if (_mat.cols && _mat.rows)
@@ -129,8 +172,6 @@ void Blob::update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, Co
         setMat(_mat);
 
         m_bounding = _boundingRect;
-        m_contour = _contour;
-        m_children = _children;
 
         ContourManager::massCenter(m_contour,m_massCenter);
 
@@ -141,9 +182,8 @@ void Blob::update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, Co
 
         initialize();
 
-        IndexVector::size_type childCount = _children.size();
+        rasterize();
 
-        bool isInHole;
         Point pixel;
 
         for (int col = m_xOffset; col <= m_bounding.br().x; ++col)
@@ -154,42 +194,31 @@ void Blob::update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, Co
             {
                 pixel.y = row;
 
-                int polygonTest = static_cast<int>(cv::pointPolygonTest(m_contour,pixel,false));
-
-                switch (polygonTest)
+                switch (m_rasterizer.location(col,row))
                 {
-                case -1:
-                    //Outside contour
+                case ContourRasterizer::L_OUTSIDE:
                     outside(pixel);
 
                     break;
-                case 1:
-                    //Inside contour
-                    isInHole = false;
-
-                    for (ContourVector::size_type i = 0; i < childCount && !isInHole; ++i)
+                case ContourRasterizer::L_INSIDE:
+                    //If PointVector pointer is defined
+                    if (isNotNullPVP(m_pPoints))
                     {
-                        isInHole = (cv::pointPolygonTest(m_children[i],pixel,false) >= 0.);
-                    }//for (ContourVector::size_type i = 0; i < childCount && !isInHole; ++i)
+                        //Fills PointVector.
+                        m_pPoints->push_back(pixel);
+                    }//if (isNotNullPVP(m_pPoints))
 
-                    if (isInHole)
-                    {
-                        inHole(pixel);
-                    }//if (isInHole)
-                    else
-                    {
-                        //If PointVector pointer is defined
-                        if (isNotNullPVP(m_pPoints))
-                        {
-                            //Fills PointVector.
-                            m_pPoints->push_back(pixel);
-                        }//if (isNotNullPVP(m_pPoints))
+                    inside(pixel);
 
-                        inside(pixel);
-                    }//if (isInHole)...else
+                    break;
+                case ContourRasterizer::L_HOLE:
+                    inHole(pixel);
 
                     break;
-                }//switch (polygonTest)
+                case ContourRasterizer::L_EDGE:
+                    //On contour: neither inside nor outside
+                    break;
+                }//switch (m_rasterizer.location(col,row))
             }//for (int row = m_yOffset; row <= m_bounding.br().y; ++row)
         }//for (int col = m_xOffset; col <= m_bounding.br().x; ++col)
 
@@ -202,7 +231,39 @@ void Blob::update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, Co
 
         releaseMat();
     }//if (_mat.cols && _mat.rows)
-}//update
+}//traverse
+
+//-------------------------
+
+/*!
+ * \brief Blob::rasterize Locates every pixel traversed regarding the contour and its children at once.
+ *        Same locations as cv::pointPolygonTest: a pixel inside the contour is in a hole when it is inside
+ *        or on the edge of one of the children, and pixels on the contour itself are skipped.
+ */
+void Blob::rasterize()
+{
+    //Traversal includes bottom right corner
+    m_rasterizer.reset(Rect(m_xOffset,m_yOffset,m_bounding.width + 1,m_bounding.height + 1));
+
+    if (m_contour.empty()) return;
+
+    m_rasterizer.setContour(&m_contour[0],static_cast<int>(m_contour.size()));
+
+    if (m_pChildContours)
+    {
+        for (int i = 0; i < m_childCount; ++i)
+        {
+            m_rasterizer.addHole(m_pChildContours->points(m_pChildIndexes[i]),m_pChildContours->length(m_pChildIndexes[i]));
+        }//for (int i = 0; i < m_childCount; ++i)
+
+        return;
+    }//if (m_pChildContours)
+
+    for (ContourVector::size_type i = 0; i < m_children.size(); ++i)
+    {
+        if (!m_children[i].empty()) m_rasterizer.addHole(&m_children[i][0],static_cast<int>(m_children[i].size()));
+    }//for (ContourVector::size_type i = 0; i < m_children.size(); ++i)
+}//rasterize
 
 //-------------------------
 
@@ -217,7 +278,7 @@ void Blob::update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, Co
  * \param _children Input _contour children.
  * \param _pPoints Output points contained in the Blob.
  */
-void Blob::update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, ContourVector & _children, PointVectorPtr & _pPoints)
+void Blob::update(const Mat & _mat, const Rect & _boundingRect, const Contour & _contour, const ContourVector & _children, PointVectorPtr & _pPoints)
 {
     setPointVector(_pPoints);
     update(_mat,_boundingRect,_contour,_children);
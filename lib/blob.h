@@ -25,10 +25,14 @@
 #include "subdetection_global.h"
 
 #include "types.h"
+#include "contourrasterizer.h"
 
 namespace SubDetection
 {
 
+class ChildIndexTable;
+class ContourStore;
+
 /*! Base class made for gathering information on a blob. It will loop through each pixel of it.*/
 class SUBDETECTIONSHARED_EXPORT Blob
 {
@@ -46,8 +50,9 @@ public:
     void resetPointVector();
     void clearPointVector();
 
-    void update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, ContourVector & _children);
-    void update(const Mat & _mat, Rect & _boundingRect, Contour & _contour, ContourVector & _children, PointVectorPtr & _pPoints);
+    void update(const Mat & _mat, const Rect & _boundingRect, const Contour & _contour, const ContourVector & _children);
+    void update(const Mat & _mat, const Rect & _boundingRect, const Contour & _contour, const ContourVector & _children, PointVectorPtr & _pPoints);
+    void update(const Mat & _mat, const Rect & _boundingRect, const ContourStore & _contours, const ChildIndexTable & _childTable, int _index);
 
 protected:
     Mat croppedMat() const;
@@ -72,6 +77,9 @@ protected:
     ContourVector m_children;
 
 private:
+    void traverse(const Mat & _mat, const Rect & _boundingRect);
+    void rasterize();
+
     void setMat(const Mat & _mat);
     void releaseMat();
 
@@ -84,6 +92,13 @@ private:
 
     QSharedPointer<PointVector> m_pPoints;
 
+    //Children read in place during ContourStore update, m_children is left empty then.
+    const ContourStore * m_pChildContours;
+    const int * m_pChildIndexes;
+    int m_childCount;
+
+    ContourRasterizer m_rasterizer;///< Pixel locations of the bounding rect, computed once per update.
+
     Q_DISABLE_COPY(Blob)
 };//Blob
 
@@ -0,0 +1,103 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "childindextable.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+const int HIERARCHY_INDEX_NEXT = 0;
+const int HIERARCHY_INDEX_FIRST_CHILD = 2;
+const int HIERARCHY_INDEX_PARENT = 3;
+}//namespace
+
+ChildIndexTable::ChildIndexTable():
+    m_offsets(1,0),
+    m_children(1,-1)//children(i) stays valid on an empty table
+{
+}//ChildIndexTable
+
+//-------------------------
+
+/*!
+ * \brief ChildIndexTable::build Builds the table from _hierarchy, as returned by cv::findContours. Previous content is dropped.
+ *        Buffers are reused.
+ */
+void ChildIndexTable::build(const Hierarchy & _hierarchy)
+{
+    int contourCount = static_cast<int>(_hierarchy.size());
+
+    m_offsets.resize(contourCount + 1);
+    m_children.clear();
+    m_parents.resize(contourCount);
+    m_depths.assign(contourCount,-1);
+
+    //Each contour is visited once as a child: linear
+    for (int i = 0; i < contourCount; ++i)
+    {
+        m_offsets[i] = static_cast<int>(m_children.size());
+        m_parents[i] = _hierarchy[i][HIERARCHY_INDEX_PARENT];
+
+        for (int child = _hierarchy[i][HIERARCHY_INDEX_FIRST_CHILD]; child >= 0; child = _hierarchy[child][HIERARCHY_INDEX_NEXT])
+        {
+            m_children.push_back(child);
+        }//for (int child = _hierarchy[i][HIERARCHY_INDEX_FIRST_CHILD]; child >= 0; ...
+    }//for (int i = 0; i < contourCount; ++i)
+
+    m_offsets[contourCount] = static_cast<int>(m_children.size());
+
+    m_children.push_back(-1);//children(i) stays valid on a contour without children
+
+    //Depths, top down from each top level contour
+    for (int i = 0; i < contourCount; ++i)
+    {
+        if (m_parents[i] >= 0) continue;
+
+        m_depths[i] = 0;
+        m_stack.push_back(i);
+
+        while (!m_stack.empty())
+        {
+            int current = m_stack.back();
+            m_stack.pop_back();
+
+            for (int child = m_offsets[current]; child < m_offsets[current + 1]; ++child)
+            {
+                m_depths[m_children[child]] = m_depths[current] + 1;
+                m_stack.push_back(m_children[child]);
+            }//for (int child = m_offsets[current]; child < m_offsets[current + 1]; ++child)
+        }//while (!m_stack.empty())
+    }//for (int i = 0; i < contourCount; ++i)
+}//build
+
+//-------------------------
+
+void ChildIndexTable::clear()
+{
+    m_offsets.assign(1,0);
+    m_children.assign(1,-1);
+    m_parents.clear();
+    m_depths.clear();
+}//clear
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,69 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_CHILDINDEXTABLE_H
+#define SUBDETECTION_CHILDINDEXTABLE_H
+
+#include <vector>
+
+#include "subdetection_global.h"
+
+#include "types.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The ChildIndexTable class. Children of every contour of an OpenCV hierarchy, stored once in a single array:
+ *        children of contour i are children(i)[0] to children(i)[childCount(i) - 1], in hierarchy order.
+ *        Avoids walking hierarchy linked lists on each query.
+ */
+class SUBDETECTIONSHARED_EXPORT ChildIndexTable
+{
+public:
+    ChildIndexTable();
+
+    void build(const Hierarchy & _hierarchy);
+    void clear();
+
+    /// Returns the number of contours.
+    int size() const {return static_cast<int>(m_parents.size());}
+    bool isEmpty() const {return m_parents.empty();}
+
+    /// Returns the number of children of contour _index. No control is made.
+    int childCount(int _index) const {return m_offsets[_index + 1] - m_offsets[_index];}
+    /// Returns the first child index of contour _index, to be read up to childCount. No control is made.
+    const int * children(int _index) const {return &m_children[0] + m_offsets[_index];}
+
+    /// Returns the parent of contour _index, -1 for a top level contour. No control is made.
+    int parent(int _index) const {return m_parents[_index];}
+    /// Returns true if contour _index is a hole border: it has an odd number of ancestors. No control is made.
+    bool isHole(int _index) const {return (m_depths[_index] & 1) != 0;}
+
+protected:
+    std::vector<int> m_offsets;///< Index of the first child of each contour in m_children, plus total child count.
+    std::vector<int> m_children;
+    std::vector<int> m_parents;
+    std::vector<int> m_depths;///< Number of ancestors of each contour.
+    std::vector<int> m_stack;///< Depth computation.
+};//ChildIndexTable
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_CHILDINDEXTABLE_H
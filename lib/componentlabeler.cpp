@@ -0,0 +1,644 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <QFuture>
+#include <QList>
+#include <QtConcurrentRun>
+
+#include "componentlabeler.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+const int MIN_BAND_ROWS = 64;///< Thinner bands cost more in thread handling and seam merging than they save.
+const int DIRTY_TILE_ROWS = 16;///< Rows compared at once with previous mask in incremental mode.
+}//namespace
+
+ComponentLabeler::ComponentLabeler():
+    m_maxThreads(1),
+    m_incremental(false),
+    m_labeledRowCount(0)
+{
+}//ComponentLabeler
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::setMaxThreads Sets the maximum number of horizontal bands labeled at the same time,
+ *        in the global QThreadPool. Bands are at least 64 rows high. 1 (default): single band, current thread only.
+ */
+void ComponentLabeler::setMaxThreads(int _maxThreads)
+{
+    m_maxThreads = qMax(_maxThreads,1);
+}//setMaxThreads
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::enableIncrementalLabeling Enable or disable incremental labeling. When enabled, each mask is
+ *        compared with the previous one by bands of 16 rows. Previous components away from changed bands are reused,
+ *        others are labeled again. Results are the same as labeling the whole mask.
+ * \param _enabled true: enable, false: disable (default). Disabling forgets previous mask.
+ */
+void ComponentLabeler::enableIncrementalLabeling(bool _enabled)
+{
+    m_incremental = _enabled;
+
+    if (!m_incremental) forget();
+}//enableIncrementalLabeling
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::forget Forgets previous mask: next one is labeled entirely.
+ */
+void ComponentLabeler::forget()
+{
+    m_previousMask.clear();
+    m_previousComponents.clear();
+}//forget
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::process Finds 8-connected components of _mask, the same connectivity as cv::findContours.
+ *        Unlike findContours with CV_RETR_EXTERNAL, components lying in a hole of another one are returned too.
+ * \param _mask Input CV_8UC1 mask. Every non null pixel belongs to a component. May be a ROI.
+ * \param _components Output components, ordered by their first pixel in raster order.
+ */
+void ComponentLabeler::process(const Mat & _mask, ComponentVector & _components)
+{
+    _components.clear();
+
+    if (!m_incremental)
+    {
+        labelRows(_mask,0,_mask.rows,_components);
+        m_labeledRowCount = _mask.rows;
+        return;
+    }//if (!m_incremental)
+
+    m_currentMask.pack(_mask);
+
+    if (m_previousMask.hasSameSize(m_currentMask))
+    {
+        relabelDirtyRows(_mask,_components);
+    }//if (m_previousMask.hasSameSize(m_currentMask))
+    else
+    {
+        labelRows(_mask,0,_mask.rows,_components);
+        m_labeledRowCount = _mask.rows;
+    }//if (m_previousMask.hasSameSize(m_currentMask))...else
+
+    m_previousMask.swap(m_currentMask);
+    m_previousComponents = _components;
+}//process
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::process Finds 8-connected components of a run-length encoded mask. Two runs of consecutive
+ *        rows are connected when they overlap or touch diagonally. Output is the same as for the decoded mask.
+ *        Always runs on the current thread, and ignores incremental labeling.
+ * \param _runs Input runs.
+ * \param _components Output components, ordered by their first pixel in raster order.
+ */
+void ComponentLabeler::process(const RleMask & _runs, ComponentVector & _components)
+{
+    _components.clear();
+
+    m_labeledRowCount = _runs.rows();
+
+    const RleMask::RunVector & runs = _runs.runs();
+    int runCount = _runs.runCount();
+
+    m_runParents.resize(runCount);
+
+    for (int i = 0; i < runCount; ++i)
+    {
+        m_runParents[i] = i;
+    }//for (int i = 0; i < runCount; ++i)
+
+    for (int y = 1; y < _runs.rows(); ++y)
+    {
+        int upper = _runs.rowOffset(y - 1);
+        int upperEnd = _runs.rowOffset(y);
+        int lowerEnd = _runs.rowOffset(y + 1);
+
+        for (int lower = upperEnd; lower < lowerEnd; ++lower)
+        {
+            const RleMask::Run & run = runs[lower];
+
+            //Skipping upper runs ending left of the run diagonal neighbour
+            while (upper < upperEnd && runs[upper].x + runs[upper].length < run.x) ++upper;
+
+            int neighbour = upper;
+
+            while (neighbour < upperEnd && runs[neighbour].x <= run.x + run.length)
+            {
+                unite(m_runParents,neighbour,lower);
+                ++neighbour;
+            }//while (neighbour < upperEnd && runs[neighbour].x <= run.x + run.length)
+
+            //Last upper run reached may touch next lower run too
+            if (neighbour > upper) upper = neighbour - 1;
+        }//for (int lower = upperEnd; lower < lowerEnd; ++lower)
+    }//for (int y = 1; y < _runs.rows(); ++y)
+
+    //A root is smaller than any run of its set, so it comes first
+    m_runComponents.resize(runCount);
+    m_runStatistics.clear();
+
+    for (int y = 0; y < _runs.rows(); ++y)
+    {
+        for (int i = _runs.rowOffset(y); i < _runs.rowOffset(y + 1); ++i)
+        {
+            const RleMask::Run & run = runs[i];
+
+            Statistics statistics;
+            statistics.minX = run.x;
+            statistics.maxX = run.x + run.length - 1;
+            statistics.minY = y;
+            statistics.maxY = y;
+            statistics.area = run.length;
+            statistics.sumX = static_cast<qint64>(statistics.minX + statistics.maxX) * run.length / 2;
+            statistics.sumY = static_cast<qint64>(y) * run.length;
+
+            int root = find(m_runParents,i);
+
+            if (root == i)
+            {
+                m_runComponents[i] = static_cast<int>(m_runStatistics.size());
+                m_runStatistics.push_back(statistics);
+            }//if (root == i)
+            else
+            {
+                m_runComponents[i] = m_runComponents[root];
+                merge(m_runStatistics[m_runComponents[i]],statistics);
+            }//if (root == i)...else
+        }//for (int i = _runs.rowOffset(y); i < _runs.rowOffset(y + 1); ++i)
+    }//for (int y = 0; y < _runs.rows(); ++y)
+
+    for (StatisticsVector::size_type i = 0; i < m_runStatistics.size(); ++i)
+    {
+        appendComponent(m_runStatistics[i],_components);
+    }//for (StatisticsVector::size_type i = 0; i < m_runStatistics.size(); ++i)
+}//process
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::labelRows Labels rows [_firstRow, _lastRow[ of _mask, in bands when several threads are allowed.
+ *        Components are appended to _components in mask coordinates.
+ */
+void ComponentLabeler::labelRows(const Mat & _mask, int _firstRow, int _lastRow, ComponentVector & _components)
+{
+    int rowCount = _lastRow - _firstRow;
+    int bandCount = qMax(1,qMin(m_maxThreads,rowCount / MIN_BAND_ROWS));
+
+    m_bands.resize(bandCount);
+
+    for (int i = 0; i < bandCount; ++i)
+    {
+        int firstRow = _firstRow + rowCount * i / bandCount;
+        int lastRow = _firstRow + rowCount * (i + 1) / bandCount;
+
+        m_bands[i].mask = _mask.rowRange(firstRow,lastRow);
+        m_bands[i].yOffset = firstRow;
+    }//for (int i = 0; i < bandCount; ++i)
+
+    if (bandCount == 1)
+    {
+        labelBand(&m_bands[0]);
+
+        const StatisticsVector & components = m_bands[0].components;
+
+        for (StatisticsVector::size_type i = 0; i < components.size(); ++i)
+        {
+            appendComponent(components[i],_components);
+        }//for (StatisticsVector::size_type i = 0; i < components.size(); ++i)
+    }//if (bandCount == 1)
+    else
+    {
+        QList<QFuture<void> > futures;
+
+        //Current thread takes the first band
+        for (int i = 1; i < bandCount; ++i)
+        {
+            futures.append(QtConcurrent::run(&ComponentLabeler::labelBand,&m_bands[i]));
+        }//for (int i = 1; i < bandCount; ++i)
+
+        labelBand(&m_bands[0]);
+
+        for (int i = 0; i < futures.size(); ++i)
+        {
+            futures[i].waitForFinished();
+        }//for (int i = 0; i < futures.size(); ++i)
+
+        mergeBands(_components);
+    }//if (bandCount == 1)...else
+
+    for (int i = 0; i < bandCount; ++i)
+    {
+        m_bands[i].mask.release();
+    }//for (int i = 0; i < bandCount; ++i)
+}//labelRows
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::labelBand Labels the rows of a band. Only touches the band: bands can be labeled concurrently.
+ */
+void ComponentLabeler::labelBand(Band * _pBand)
+{
+    Band & band = *_pBand;
+    const Mat & mask = band.mask;
+
+    band.parents.assign(1,0);//Label 0 is background
+    band.statistics.resize(1);
+    band.components.clear();
+
+    //One extra column on each side: neighbours of border pixels are background
+    band.previousRow.assign(mask.cols + 2,0);
+    band.currentRow.assign(mask.cols + 2,0);
+    band.firstRowComponents.assign(mask.cols,0);
+    band.lastRowComponents.assign(mask.cols,0);
+
+    for (int y = 0; y < mask.rows; ++y)
+    {
+        const uchar * pPixels = mask.ptr<uchar>(y);
+        int * pPrevious = &band.previousRow[1];
+        int * pCurrent = &band.currentRow[1];
+
+        for (int x = 0; x < mask.cols; ++x)
+        {
+            if (!pPixels[x])
+            {
+                pCurrent[x] = 0;
+                continue;
+            }//if (!pPixels[x])
+
+            int label;
+
+            //Pixel above touches both upper corners and left pixel: they are already in its set
+            if (pPrevious[x])
+            {
+                label = pPrevious[x];
+            }//if (pPrevious[x])
+            else if (pPrevious[x + 1])
+            {
+                label = pPrevious[x + 1];
+
+                //Left pixel, if any, is in the same set as upper left one
+                if (pCurrent[x - 1])
+                    unite(band.parents,label,pCurrent[x - 1]);
+                else if (pPrevious[x - 1])
+                    unite(band.parents,label,pPrevious[x - 1]);
+            }//else if (pPrevious[x + 1])
+            else if (pPrevious[x - 1])
+            {
+                label = pPrevious[x - 1];
+            }//else if (pPrevious[x - 1])
+            else if (pCurrent[x - 1])
+            {
+                label = pCurrent[x - 1];
+            }//else if (pCurrent[x - 1])
+            else
+            {
+                label = newLabel(band);
+            }//else
+
+            pCurrent[x] = label;
+            addPixel(band.statistics[label],x,y + band.yOffset);
+        }//for (int x = 0; x < mask.cols; ++x)
+
+        //Provisional labels of seam rows, resolved below
+        if (!y) std::copy(pCurrent,pCurrent + mask.cols,band.firstRowComponents.begin());
+        if (y == mask.rows - 1) std::copy(pCurrent,pCurrent + mask.cols,band.lastRowComponents.begin());
+
+        band.previousRow.swap(band.currentRow);
+    }//for (int y = 0; y < mask.rows; ++y)
+
+    //Merging statistics into roots. A root is smaller than any label of its set, so it comes first.
+    int labelCount = static_cast<int>(band.parents.size());
+
+    band.componentIndexes.resize(labelCount);
+    band.componentIndexes[0] = 0;
+
+    for (int label = 1; label < labelCount; ++label)
+    {
+        int root = find(band.parents,label);
+
+        if (root == label)
+        {
+            band.components.push_back(band.statistics[label]);
+            band.componentIndexes[label] = static_cast<int>(band.components.size());
+        }//if (root == label)
+        else
+        {
+            merge(band.components[band.componentIndexes[root] - 1],band.statistics[label]);
+            band.componentIndexes[label] = band.componentIndexes[root];
+        }//if (root == label)...else
+    }//for (int label = 1; label < labelCount; ++label)
+
+    for (int x = 0; x < mask.cols; ++x)
+    {
+        band.firstRowComponents[x] = band.componentIndexes[band.firstRowComponents[x]];
+        band.lastRowComponents[x] = band.componentIndexes[band.lastRowComponents[x]];
+    }//for (int x = 0; x < mask.cols; ++x)
+}//labelBand
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::mergeBands Unites components touching across band seams, then outputs merged components.
+ *        Band components are numbered band after band: the smallest number of a merged set is its first pixel in
+ *        raster order, so output order is the same as with a single band.
+ */
+void ComponentLabeler::mergeBands(ComponentVector & _components)
+{
+    m_seamStatistics.clear();
+
+    LabelVector firstIndexes(m_bands.size());
+
+    for (BandVector::size_type i = 0; i < m_bands.size(); ++i)
+    {
+        firstIndexes[i] = static_cast<int>(m_seamStatistics.size());
+        m_seamStatistics.insert(m_seamStatistics.end(),m_bands[i].components.begin(),m_bands[i].components.end());
+    }//for (BandVector::size_type i = 0; i < m_bands.size(); ++i)
+
+    int componentCount = static_cast<int>(m_seamStatistics.size());
+
+    m_seamParents.resize(componentCount);
+
+    for (int i = 0; i < componentCount; ++i)
+    {
+        m_seamParents[i] = i;
+    }//for (int i = 0; i < componentCount; ++i)
+
+    for (BandVector::size_type i = 1; i < m_bands.size(); ++i)
+    {
+        const LabelVector & upperRow = m_bands[i - 1].lastRowComponents;
+        const LabelVector & lowerRow = m_bands[i].firstRowComponents;
+        int columnCount = static_cast<int>(lowerRow.size());
+
+        for (int x = 0; x < columnCount; ++x)
+        {
+            if (!lowerRow[x]) continue;
+
+            int lower = firstIndexes[i] + lowerRow[x] - 1;
+
+            for (int neighbour = qMax(x - 1,0); neighbour <= qMin(x + 1,columnCount - 1); ++neighbour)
+            {
+                if (upperRow[neighbour]) unite(m_seamParents,firstIndexes[i - 1] + upperRow[neighbour] - 1,lower);
+            }//for (int neighbour = qMax(x - 1,0); neighbour <= qMin(x + 1,columnCount - 1); ++neighbour)
+        }//for (int x = 0; x < columnCount; ++x)
+    }//for (BandVector::size_type i = 1; i < m_bands.size(); ++i)
+
+    for (int i = 0; i < componentCount; ++i)
+    {
+        int root = find(m_seamParents,i);
+
+        if (root != i) merge(m_seamStatistics[root],m_seamStatistics[i]);
+    }//for (int i = 0; i < componentCount; ++i)
+
+    for (int i = 0; i < componentCount; ++i)
+    {
+        if (m_seamParents[i] == i) appendComponent(m_seamStatistics[i],_components);
+    }//for (int i = 0; i < componentCount; ++i)
+}//mergeBands
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::markDirtyRows Marks rows of bands which differ between previous and current masks,
+ *        then rows of every previous component touching a marked row or the row just above or below.
+ *        Repeated until stable: unmarked rows next to marked ones are then background, so marked row ranges can be
+ *        labeled apart, and previous components left unmarked are unchanged.
+ */
+void ComponentLabeler::markDirtyRows()
+{
+    int rowCount = m_currentMask.rows();
+    int wordsPerRow = m_currentMask.wordsPerRow();
+
+    m_dirtyRows.assign(rowCount,0);
+
+    bool dirty = false;
+
+    for (int firstRow = 0; firstRow < rowCount; firstRow += DIRTY_TILE_ROWS)
+    {
+        int lastRow = qMin(firstRow + DIRTY_TILE_ROWS,rowCount);
+        const PackedMask::Word * pCurrent = m_currentMask.row(firstRow);
+
+        if (!std::equal(pCurrent,pCurrent + (lastRow - firstRow) * wordsPerRow,m_previousMask.row(firstRow)))
+        {
+            std::fill(m_dirtyRows.begin() + firstRow,m_dirtyRows.begin() + lastRow,1);
+            dirty = true;
+        }//if (!std::equal(...
+    }//for (int firstRow = 0; firstRow < rowCount; firstRow += DIRTY_TILE_ROWS)
+
+    m_keptComponents.assign(m_previousComponents.size(),1);
+    m_dirtyRowSums.resize(rowCount + 1);
+
+    while (dirty)
+    {
+        dirty = false;
+
+        m_dirtyRowSums[0] = 0;
+
+        for (int y = 0; y < rowCount; ++y)
+        {
+            m_dirtyRowSums[y + 1] = m_dirtyRowSums[y] + m_dirtyRows[y];
+        }//for (int y = 0; y < rowCount; ++y)
+
+        for (ComponentVector::size_type i = 0; i < m_previousComponents.size(); ++i)
+        {
+            if (!m_keptComponents[i]) continue;
+
+            const Rect & bounding = m_previousComponents[i].bounding;
+            int top = qMax(bounding.y - 1,0);
+            int bottom = qMin(bounding.y + bounding.height + 1,rowCount);
+
+            if (m_dirtyRowSums[bottom] == m_dirtyRowSums[top]) continue;
+
+            m_keptComponents[i] = 0;
+            std::fill(m_dirtyRows.begin() + bounding.y,m_dirtyRows.begin() + bounding.y + bounding.height,1);
+            dirty = true;
+        }//for (ComponentVector::size_type i = 0; i < m_previousComponents.size(); ++i)
+    }//while (dirty)
+}//markDirtyRows
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::relabelDirtyRows Labels again ranges of dirty rows only, then merges their components
+ *        with previous ones kept, in raster order of first pixels.
+ */
+void ComponentLabeler::relabelDirtyRows(const Mat & _mask, ComponentVector & _components)
+{
+    markDirtyRows();
+
+    m_newComponents.clear();
+    m_labeledRowCount = 0;
+
+    int rowCount = _mask.rows;
+
+    for (int y = 0; y < rowCount;)
+    {
+        if (!m_dirtyRows[y])
+        {
+            ++y;
+            continue;
+        }//if (!m_dirtyRows[y])
+
+        int firstRow = y;
+
+        while (y < rowCount && m_dirtyRows[y]) ++y;
+
+        labelRows(_mask,firstRow,y,m_newComponents);
+        m_labeledRowCount += y - firstRow;
+    }//for (int y = 0; y < rowCount;)
+
+    //Kept and new components never share a row: first rows alone give raster order
+    ComponentVector::size_type previous = 0;
+    ComponentVector::size_type next = 0;
+
+    _components.reserve(m_previousComponents.size() + m_newComponents.size());
+
+    while (previous < m_previousComponents.size() || next < m_newComponents.size())
+    {
+        if (previous < m_previousComponents.size() && !m_keptComponents[previous])
+        {
+            ++previous;
+        }//if (previous < m_previousComponents.size() && !m_keptComponents[previous])
+        else if (next < m_newComponents.size()
+              && (previous == m_previousComponents.size()
+               || m_newComponents[next].bounding.y < m_previousComponents[previous].bounding.y))
+        {
+            _components.push_back(m_newComponents[next++]);
+        }//else if (next < m_newComponents.size()...
+        else
+        {
+            _components.push_back(m_previousComponents[previous++]);
+        }//else
+    }//while (previous < m_previousComponents.size() || next < m_newComponents.size())
+}//relabelDirtyRows
+
+//-------------------------
+
+int ComponentLabeler::newLabel(Band & _band)
+{
+    int label = static_cast<int>(_band.parents.size());
+
+    _band.parents.push_back(label);
+
+    Statistics statistics;
+    statistics.minX = std::numeric_limits<int>::max();
+    statistics.minY = std::numeric_limits<int>::max();
+    statistics.maxX = -1;
+    statistics.maxY = -1;
+    statistics.area = 0;
+    statistics.sumX = 0;
+    statistics.sumY = 0;
+
+    _band.statistics.push_back(statistics);
+
+    return label;
+}//newLabel
+
+//-------------------------
+
+/*!
+ * \brief ComponentLabeler::find Returns the root of _label set. Compresses the path on the way.
+ */
+int ComponentLabeler::find(LabelVector & _parents, int _label)
+{
+    while (_parents[_label] != _label)
+    {
+        _parents[_label] = _parents[_parents[_label]];
+        _label = _parents[_label];
+    }//while (_parents[_label] != _label)
+
+    return _label;
+}//find
+
+//-------------------------
+
+void ComponentLabeler::unite(LabelVector & _parents, int _first, int _second)
+{
+    int firstRoot = find(_parents,_first);
+    int secondRoot = find(_parents,_second);
+
+    if (firstRoot < secondRoot)
+        _parents[secondRoot] = firstRoot;
+    else
+        _parents[firstRoot] = secondRoot;
+}//unite
+
+//-------------------------
+
+void ComponentLabeler::addPixel(Statistics & _statistics, int _x, int _y)
+{
+    if (_x < _statistics.minX) _statistics.minX = _x;
+    if (_x > _statistics.maxX) _statistics.maxX = _x;
+    if (_y < _statistics.minY) _statistics.minY = _y;
+    if (_y > _statistics.maxY) _statistics.maxY = _y;
+
+    ++_statistics.area;
+    _statistics.sumX += _x;
+    _statistics.sumY += _y;
+}//addPixel
+
+//-------------------------
+
+/// Adds _statistics to _root ones.
+void ComponentLabeler::merge(Statistics & _root, const Statistics & _statistics)
+{
+    _root.minX = qMin(_root.minX,_statistics.minX);
+    _root.minY = qMin(_root.minY,_statistics.minY);
+    _root.maxX = qMax(_root.maxX,_statistics.maxX);
+    _root.maxY = qMax(_root.maxY,_statistics.maxY);
+    _root.area += _statistics.area;
+    _root.sumX += _statistics.sumX;
+    _root.sumY += _statistics.sumY;
+}//merge
+
+//-------------------------
+
+void ComponentLabeler::appendComponent(const Statistics & _statistics, ComponentVector & _components)
+{
+    Component component;
+    component.bounding = Rect(_statistics.minX,_statistics.minY,
+                              _statistics.maxX - _statistics.minX + 1,
+                              _statistics.maxY - _statistics.minY + 1);
+    component.area = _statistics.area;
+    component.massCenter.x = lround(static_cast<double>(_statistics.sumX) / _statistics.area);
+    component.massCenter.y = lround(static_cast<double>(_statistics.sumY) / _statistics.area);
+
+    _components.push_back(component);
+}//appendComponent
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,145 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_COMPONENTLABELER_H
+#define SUBDETECTION_COMPONENTLABELER_H
+
+#include <vector>
+
+#include "subdetection_global.h"
+
+#include "types.h"
+#include "packedmask.h"
+#include "rlemask.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The ComponentLabeler class. Finds 8-connected components of a binary mask in a single raster pass,
+ *        with bounding rect, area and mass center of each one. No label image and no contour point is stored:
+ *        only two rows of provisional labels and one statistics record per label.
+ *        Tall masks may be split into horizontal bands labeled in parallel. Components crossing band seams are
+ *        merged afterwards: results are the same as with a single band.
+ *        In incremental mode, only rows around changes since previous mask are labeled again, see enableIncrementalLabeling.
+ *        Run-length encoded masks are labeled run by run: time grows with the number of runs instead of the mask area.
+ */
+class SUBDETECTIONSHARED_EXPORT ComponentLabeler
+{
+public:
+    /// Statistics of one 8-connected component.
+    struct Component
+    {
+        Rect bounding;
+        int area;///< Pixel count.
+        Point massCenter;///< Rounded mean of pixel coordinates.
+    };//Component
+
+    typedef std::vector<Component> ComponentVector;
+
+    ComponentLabeler();
+
+    void setMaxThreads(int _maxThreads);
+    /// Returns the maximum number of bands labeled at the same time.
+    int maxThreads() const {return m_maxThreads;}
+
+    void enableIncrementalLabeling(bool _enabled);
+    /// Returns true if only rows changed since previous mask are labeled again.
+    bool incrementalLabeling() const {return m_incremental;}
+    void forget();
+
+    void process(const Mat & _mask, ComponentVector & _components);
+    void process(const RleMask & _runs, ComponentVector & _components);
+
+    /// Returns how many rows were labeled during last call to "process". Less than mask rows when components were reused.
+    int labeledRowCount() const {return m_labeledRowCount;}
+
+protected:
+    /// Statistics accumulated for a provisional label.
+    struct Statistics
+    {
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+        int area;
+        qint64 sumX;
+        qint64 sumY;
+    };//Statistics
+
+    typedef std::vector<int> LabelVector;
+    typedef std::vector<Statistics> StatisticsVector;
+
+    /// Labeling state and result of a band of rows.
+    struct Band
+    {
+        Mat mask;///< Band rows.
+        int yOffset;///< Index of the first band row in the whole mask.
+
+        LabelVector parents;///< Union-find forest. A root is the smallest label of its set.
+        StatisticsVector statistics;
+        LabelVector previousRow;
+        LabelVector currentRow;
+        LabelVector componentIndexes;///< 1 based component index of each label.
+
+        StatisticsVector components;///< Root statistics, ordered by first pixel in raster order.
+        LabelVector firstRowComponents;///< 1 based component index of first row pixels. 0: background.
+        LabelVector lastRowComponents;///< 1 based component index of last row pixels. 0: background.
+    };//Band
+
+    typedef std::vector<Band> BandVector;
+
+    static void labelBand(Band * _pBand);
+    static int newLabel(Band & _band);
+    static int find(LabelVector & _parents, int _label);
+    static void unite(LabelVector & _parents, int _first, int _second);
+    static void addPixel(Statistics & _statistics, int _x, int _y);
+    static void merge(Statistics & _root, const Statistics & _statistics);
+    static void appendComponent(const Statistics & _statistics, ComponentVector & _components);
+
+    void labelRows(const Mat & _mask, int _firstRow, int _lastRow, ComponentVector & _components);
+    void mergeBands(ComponentVector & _components);
+
+    void markDirtyRows();
+    void relabelDirtyRows(const Mat & _mask, ComponentVector & _components);
+
+    int m_maxThreads;
+    BandVector m_bands;
+
+    LabelVector m_seamParents;///< Union-find forest of all band components, across seams.
+    StatisticsVector m_seamStatistics;
+
+    bool m_incremental;
+    PackedMask m_previousMask;
+    PackedMask m_currentMask;
+    ComponentVector m_previousComponents;///< Output of last call to "process", in incremental mode.
+    std::vector<uchar> m_dirtyRows;///< Non zero: row is labeled again.
+    LabelVector m_dirtyRowSums;///< Number of dirty rows above each row.
+    std::vector<uchar> m_keptComponents;///< Non zero: previous component is reused as is.
+    ComponentVector m_newComponents;
+    int m_labeledRowCount;
+
+    LabelVector m_runParents;///< Union-find forest of runs. A root is the first run of its component.
+    LabelVector m_runComponents;///< Component index of each run.
+    StatisticsVector m_runStatistics;
+};//ComponentLabeler
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_COMPONENTLABELER_H
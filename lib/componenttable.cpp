@@ -0,0 +1,96 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "componenttable.h"
+
+namespace SubDetection
+{
+
+void ComponentTable::clear()
+{
+    massCenters.clear();
+    boundings.clear();
+    areas.clear();
+    indexes.clear();
+}//clear
+
+//-------------------------
+
+void ComponentTable::reserve(int _size)
+{
+    massCenters.reserve(_size);
+    boundings.reserve(_size);
+    areas.reserve(_size);
+    indexes.reserve(_size);
+}//reserve
+
+//-------------------------
+
+void ComponentTable::append(const Point & _massCenter, const Rect & _bounding, int _area, Index _index)
+{
+    massCenters.push_back(_massCenter);
+    boundings.push_back(_bounding);
+    areas.push_back(_area);
+    indexes.push_back(_index);
+}//append
+
+//-------------------------
+
+/*!
+ * \brief ComponentTable::filter Keeps components whose mass center lies in _zone and whose bounding rect is not bigger than _maxSize.
+ *        Selection is computed over the coordinate arrays first, then kept rows are copied in the same order.
+ * \param _zone Zone mass centers must lie in.
+ * \param _maxSize Maximum bounding rect size.
+ * \param _result Output table. Must not be this table.
+ */
+void ComponentTable::filter(const Rect & _zone, const Size & _maxSize, ComponentTable & _result) const
+{
+    int componentCount = size();
+
+    std::vector<uchar> kept(componentCount);
+
+    const Point * pCenters = massCenters.empty() ? 0 : &massCenters[0];
+    const Rect * pBoundings = boundings.empty() ? 0 : &boundings[0];
+
+    int right = _zone.x + _zone.width;
+    int bottom = _zone.y + _zone.height;
+    int keptCount = 0;
+
+    //No branch: selection only
+    for (int i = 0; i < componentCount; ++i)
+    {
+        kept[i] = (pCenters[i].x >= _zone.x) & (pCenters[i].x < right)
+                & (pCenters[i].y >= _zone.y) & (pCenters[i].y < bottom)
+                & (pBoundings[i].width <= _maxSize.width) & (pBoundings[i].height <= _maxSize.height);
+
+        keptCount += kept[i];
+    }//for (int i = 0; i < componentCount; ++i)
+
+    _result.clear();
+    _result.reserve(keptCount);
+
+    for (int i = 0; i < componentCount; ++i)
+    {
+        if (kept[i]) _result.append(massCenters[i],boundings[i],areas[i],indexes[i]);
+    }//for (int i = 0; i < componentCount; ++i)
+}//filter
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,57 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_COMPONENTTABLE_H
+#define SUBDETECTION_COMPONENTTABLE_H
+
+#include <vector>
+
+#include "subdetection_global.h"
+
+#include "types.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The ComponentTable class. Character candidates stored as parallel arrays: row i of every array describes
+ *        the same component. Rows are carried through filtering and line grouping, so a component is never looked up
+ *        by its mass center and two components sharing a mass center stay distinct.
+ */
+class SUBDETECTIONSHARED_EXPORT ComponentTable
+{
+public:
+    PointVector massCenters;
+    RectVector boundings;
+    std::vector<int> areas;///< Pixel count with component extraction, contour area otherwise.
+    IndexVector indexes;///< Index of the component in ContourManager results.
+
+    int size() const {return static_cast<int>(indexes.size());}
+    bool isEmpty() const {return indexes.empty();}
+
+    void clear();
+    void reserve(int _size);
+    void append(const Point & _massCenter, const Rect & _bounding, int _area, Index _index);
+
+    void filter(const Rect & _zone, const Size & _maxSize, ComponentTable & _result) const;
+};//ComponentTable
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_COMPONENTTABLE_H
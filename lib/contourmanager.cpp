@@ -101,6 +101,26 @@ void ContourManager::children(const ContourVector & _contours, const Hierarchy &
 
 //-------------------------
 
+/*!
+ * \brief children Same as above, with contours kept in a ContourStore. Only children points are copied.
+ */
+void ContourManager::children(const ContourStore & _contours, const Hierarchy & _hierarchy, int _parentIndex, ContourVector & _children)
+{
+    _children.clear();
+
+    int currentChild = _hierarchy[_parentIndex][HIERARCHY_INDEX_FIRST_CHILD];//First child
+
+    while (currentChild >= 0)
+    {
+        _children.push_back(Contour());
+        _contours.contour(currentChild,_children.back());
+
+        currentChild = _hierarchy[currentChild][HIERARCHY_INDEX_NEXT];
+    }//while (currentChild >= 0)
+}//children ContourStore
+
+//-------------------------
+
 /*!
  * \brief childCount Returns the number of children for the given contour. No control is made.
  * \param _hierarchy OpenCV contour hierarchy used to find children.
@@ -143,6 +163,12 @@ ContourManager::ContourManager():
     m_binThresh(DEFAULT_BIN_THRESH),
     m_cvRetrievalMode(DEFAULT_CONTOUR_RETRIEVAL_MODE),
     m_cvApproxMethod(DEFAULT_CONTOUR_APPROX_METHOD),
+    m_extractionMethod(EM_CONTOURS),
+    m_inputFormat(IF_COLOR),
+    m_minSize(0,0),
+    m_minArea(0),
+    m_droppedCount(0),
+    m_contoursCopied(false),
     m_lastFlags(SFNone)
 {
 }//ContourManager
@@ -157,6 +183,12 @@ ContourManager::ContourManager(Thresh _binThresh):
     m_binThresh(_binThresh),
     m_cvRetrievalMode(DEFAULT_CONTOUR_RETRIEVAL_MODE),
     m_cvApproxMethod(DEFAULT_CONTOUR_APPROX_METHOD),
+    m_extractionMethod(EM_CONTOURS),
+    m_inputFormat(IF_COLOR),
+    m_minSize(0,0),
+    m_minArea(0),
+    m_droppedCount(0),
+    m_contoursCopied(false),
     m_lastFlags(SFNone)
 {
 }//ContourManager Thresh
@@ -172,6 +204,12 @@ ContourManager::ContourManager(int _cvRetrievalMode, int _cvApproxMethod):
     m_binThresh(DEFAULT_BIN_THRESH),
     m_cvRetrievalMode(_cvRetrievalMode),
     m_cvApproxMethod(_cvApproxMethod),
+    m_extractionMethod(EM_CONTOURS),
+    m_inputFormat(IF_COLOR),
+    m_minSize(0,0),
+    m_minArea(0),
+    m_droppedCount(0),
+    m_contoursCopied(false),
     m_lastFlags(SFNone)
 {
 }//ContourManager int int
@@ -189,6 +227,12 @@ ContourManager::ContourManager(Thresh _binThresh, int _cvRetrievalMode, int _cvA
     m_binThresh(_binThresh),
     m_cvRetrievalMode(_cvRetrievalMode),
     m_cvApproxMethod(_cvApproxMethod),
+    m_extractionMethod(EM_CONTOURS),
+    m_inputFormat(IF_COLOR),
+    m_minSize(0,0),
+    m_minArea(0),
+    m_droppedCount(0),
+    m_contoursCopied(false),
     m_lastFlags(SFNone)
 {
 }//ContourManager Thresh int int bool
@@ -228,13 +272,81 @@ void ContourManager::setApproxMethod(int _cvApproxMethod)
 
 //-------------------------
 
-void ContourManager::contours(ContourVector & _contours) const
+/*!
+ * \brief ContourManager::setExtractionMethod Defines how shapes are extracted. See ExtractionMethod.
+ *        With EM_COMPONENTS or EM_RUNS, a single channel image is used as a binary mask directly: every non null pixel is foreground.
+ * \param _method
+ */
+void ContourManager::setExtractionMethod(ExtractionMethod _method)
+{
+    m_extractionMethod = _method;
+}//setExtractionMethod
+
+//-------------------------
+
+/*!
+ * \brief ContourManager::setNoiseLimits Shapes narrower or shorter than _minSize, or with an area below _minArea, are dropped
+ *        as soon as they are extracted: they get no bounding rect nor mass center. 0 disables a limit.
+ *        Ignored with SFHierarchy, since dropping contours would break hierarchy links.
+ * \param _minSize Minimum bounding rect size.
+ * \param _minArea Minimum area: pixel count with EM_COMPONENTS or EM_RUNS, contour area otherwise.
+ */
+void ContourManager::setNoiseLimits(const Size & _minSize, int _minArea)
+{
+    m_minSize = _minSize;
+    m_minArea = _minArea;
+}//setNoiseLimits
+
+//-------------------------
+
+/*!
+ * \brief ContourManager::setMaxThreads Sets how many horizontal bands of the mask are labeled at the same time.
+ *        Only used with EM_COMPONENTS: contour tracing always runs on the current thread.
+ * \param _maxThreads See ComponentLabeler::setMaxThreads.
+ */
+void ContourManager::setMaxThreads(int _maxThreads)
+{
+    m_labeler.setMaxThreads(_maxThreads);
+}//setMaxThreads
+
+//-------------------------
+
+/*!
+ * \brief ContourManager::enableIncrementalLabeling With EM_COMPONENTS, only labels again the rows of the mask which
+ *        changed since previous call to "process", along with components touching them. Ignored by contour tracing.
+ * \param _enabled See ComponentLabeler::enableIncrementalLabeling.
+ */
+void ContourManager::enableIncrementalLabeling(bool _enabled)
+{
+    m_labeler.enableIncrementalLabeling(_enabled);
+}//enableIncrementalLabeling
+
+//-------------------------
+
+/*!
+ * \brief ContourManager::contours Returns last found contours. They are copied out of the contour store on first call only:
+ *        prefer contourStore when possible.
+ */
+const ContourVector & ContourManager::contours() const
 {
-    _contours = m_tempContours;
+    if (!m_contoursCopied)
+    {
+        m_contourStore.contours(m_tempContours);
+        m_contoursCopied = true;
+    }//if (!m_contoursCopied)
+
+    return m_tempContours;
 }//contours
 
 //-------------------------
 
+void ContourManager::contours(ContourVector & _contours) const
+{
+    _contours = contours();
+}//contours ContourVector
+
+//-------------------------
+
 void ContourManager::contours(ContourVector & _contours, Hierarchy & _hierarchy) const
 {
     contours(_contours);
@@ -265,6 +377,38 @@ void ContourManager::massCenters(PointVector & _massCenters) const
 
 //-------------------------
 
+/*!
+ * \brief areas Use this function to retrieve the area of each shape after a call to process with SFMassCenters:
+ *        pixel count with EM_COMPONENTS or EM_RUNS, contour area otherwise.
+ * \param _areas Output areas.
+ */
+void ContourManager::areas(std::vector<int> & _areas) const
+{
+    _areas = m_tempAreas;
+}//areas
+
+//-------------------------
+
+/*!
+ * \brief components Use this function to retrieve mass centers, bounding rects and areas as a table after a call to process
+ *        with SFBoundings and SFMassCenters. Table indexes are the shape indexes.
+ * \param _components Output table.
+ */
+void ContourManager::components(ComponentTable & _components) const
+{
+    int componentCount = static_cast<int>(qMin(m_tempMassCenters.size(),m_tempBoundings.size()));
+
+    _components.clear();
+    _components.reserve(componentCount);
+
+    for (int i = 0; i < componentCount; ++i)
+    {
+        _components.append(m_tempMassCenters[i],m_tempBoundings[i],m_tempAreas[i],i);
+    }//for (int i = 0; i < componentCount; ++i)
+}//components
+
+//-------------------------
+
 /*!
  * \brief attributes Fill _attributes with last computed items. Must be called after process.
  * \param _attributes Output attributes.*/
@@ -286,22 +430,62 @@ void ContourManager::attributes(Attributes & _attributes) const
 
 //-------------------------
 
+/*!
+ * \brief ContourManager::takeAttributes Moves last computed items into _attributes without copying them.
+ *        Previous content of _attributes is dropped. Items are no longer available from this manager afterwards.
+ *        Must be called after process.
+ * \param _attributes Output attributes.
+ */
+void ContourManager::takeAttributes(Attributes & _attributes)
+{
+    _attributes.flags = m_lastFlags;
+
+    contours();
+    _attributes.contours.swap(m_tempContours);
+    _attributes.hierarchy.swap(m_tempHierarchy);
+    _attributes.boundings.swap(m_tempBoundings);
+    _attributes.massCenters.swap(m_tempMassCenters);
+
+    m_tempContours.clear();
+    m_tempHierarchy.clear();
+    m_tempBoundings.clear();
+    m_tempMassCenters.clear();
+    m_tempAreas.clear();
+
+    m_contourStore.clear();
+    m_childTable.clear();
+}//takeAttributes
+
+//-------------------------
+
 void ContourManager::process(Mat & _mat, SelectionFlags _flags)
 {
     setImage(_mat);
 
     m_lastFlags = _flags;
 
+    if (m_extractionMethod == EM_COMPONENTS || m_extractionMethod == EM_RUNS)
+    {
+        buildComponents(_mat,_flags);
+        return;
+    }//if (m_extractionMethod == EM_COMPONENTS || m_extractionMethod == EM_RUNS)
+
     if (_flags & SFHierarchy)
-        buildContours(m_tempContours,m_tempHierarchy);
+    {
+        buildContours(m_tempHierarchy);
+        m_childTable.build(m_tempHierarchy);
+    }//if (_flags & SFHierarchy)
     else
-        buildContours(m_tempContours);
+    {
+        buildContours();
+        rejectNoise();
+    }//if (_flags & SFHierarchy)...else
 
     if (_flags & SFBoundings)
-        buildBoundings(m_tempContours,m_tempBoundings);
+        buildBoundings(m_contourStore,m_tempBoundings);
 
     if (_flags & SFMassCenters)
-        buildMassCenters(m_tempContours,m_tempMassCenters);
+        buildMassCenters(m_contourStore,m_tempMassCenters,m_tempAreas);
 }//process Mat
 
 //-------------------------
@@ -313,11 +497,52 @@ void ContourManager::process(Mat & _mat, SelectionFlags _flags)
  */
 void ContourManager::process(const Mat & _mat, SelectionFlags _flags)
 {
-    process(_mat.clone(),_flags);
+    process(_mat,IF_COLOR,_flags);
 }//process const Mat
 
 //-------------------------
 
+/*!
+ * \brief process Process the image contained in _mat according to _flags.
+ *        With IF_BINARY, _mat is used as the contour search image: gray conversion and threshold are skipped.
+ *        _mat is not copied: it is only read, contour search works on its own image.
+ * \param _mat Input image. Must be CV_8UC1 with IF_BINARY.
+ * \param _format Input image content.
+ * \param _flags Computing parameters.
+ */
+void ContourManager::process(const Mat & _mat, InputFormat _format, SelectionFlags _flags)
+{
+    m_inputFormat = _format;
+
+    //Header only: neither component labeling nor gray conversion modifies the image, findContours gets m_contourMat
+    Mat mat = _mat;
+    process(mat,_flags);
+
+    m_inputFormat = IF_COLOR;
+}//process const Mat InputFormat
+
+//-------------------------
+
+/*!
+ * \brief process Labels components of a mask already run-length encoded, e.g. by HsvMaskTable. Same results as
+ *        EM_RUNS on the decoded mask, whatever the extraction method. No contour nor hierarchy is built.
+ * \param _runs Input runs.
+ * \param _flags Computing parameters. SFHierarchy is ignored.
+ */
+void ContourManager::process(const RleMask & _runs, SelectionFlags _flags)
+{
+    Mat noImage;
+    setImage(noImage);
+
+    m_lastFlags = _flags;
+
+    m_labeler.process(_runs,m_components);
+
+    keepComponents(_flags);
+}//process RleMask
+
+//-------------------------
+
 /*!
  * \brief ContourManager::setImage Defines the image. _mat may be modified.
  * \warning Don't modify _mat while you want this class to work on it.
@@ -326,11 +551,16 @@ void ContourManager::process(const Mat & _mat, SelectionFlags _flags)
 void ContourManager::setImage(Mat & _mat)
 {
     m_originalMat = _mat;
+    m_droppedCount = 0;
 
+    m_contourStore.clear();
     m_tempContours.clear();
+    m_contoursCopied = false;
     m_tempBoundings.clear();
     m_tempMassCenters.clear();
     m_tempHierarchy.clear();
+    m_childTable.clear();
+    m_tempAreas.clear();
 }//setImage Mat &
 
 //-------------------------
@@ -346,26 +576,39 @@ void ContourManager::setImage(Mat & _mat)
 
 //-------------------------
 */
-void ContourManager::buildContours(ContourVector & _contours)
+void ContourManager::prepareImage()
+{
+    if (m_inputFormat == IF_BINARY)
+    {
+        //findContours modifies its input
+        m_originalMat.copyTo(m_contourMat);
+    }//if (m_inputFormat == IF_BINARY)
+    else
+    {
+        prepareContourSearch(m_originalMat,m_binThresh,m_grayMat,m_contourMat);
+    }//if (m_inputFormat == IF_BINARY)...else
+}//prepareImage
+
+//-------------------------
+
+void ContourManager::buildContours()
 {
-    prepareContourSearch(m_originalMat,m_binThresh,m_grayMat,m_contourMat);
+    prepareImage();
 
-    cv::findContours(m_contourMat, _contours,
-                     m_cvRetrievalMode,
-                     m_cvApproxMethod,
-                     Point(0, 0));
+    m_contourStore.find(m_contourMat,
+                        m_cvRetrievalMode,
+                        m_cvApproxMethod);
 }//buildContours
 
 //-------------------------
 
-void ContourManager::buildContours(ContourVector & _contours, Hierarchy & _hierarchy)
+void ContourManager::buildContours(Hierarchy & _hierarchy)
 {
-    prepareContourSearch(m_originalMat,m_binThresh,m_grayMat,m_contourMat);
+    prepareImage();
 
-    cv::findContours(m_contourMat, _contours, _hierarchy,
-                     m_cvRetrievalMode,
-                     m_cvApproxMethod,
-                     Point(0, 0));
+    m_contourStore.find(m_contourMat, _hierarchy,
+                        m_cvRetrievalMode,
+                        m_cvApproxMethod);
 }//buildContours
 
 //-------------------------
@@ -375,9 +618,9 @@ void ContourManager::buildContours(ContourVector & _contours, Hierarchy & _hiera
  * \param _contours Input contours.
  * \param _massCenters Output bounding rects. Its size must be at least equal to _contours size. No control is made.
  */
-void ContourManager::buildBoundings(const ContourVector & _contours, RectVector & _boundings)
+void ContourManager::buildBoundings(const ContourStore & _contours, RectVector & _boundings)
 {
-    ContourVector::size_type contourSize = _contours.size();
+    int contourSize = _contours.size();
     _boundings.resize(contourSize);
 
 #if SD_APPROX_CURVES
@@ -386,15 +629,15 @@ void ContourManager::buildBoundings(const ContourVector & _contours, RectVector
 #endif//SD_APPROX_CURVES
 
     //Retrieving bounding rects
-    for(ContourVector::size_type i = 0; i < contourSize; ++i)
+    for(int i = 0; i < contourSize; ++i)
     {
 #if SD_APPROX_CURVES
-        cv::approxPolyDP(cv::Mat(_contours[i]), contourCurves[i], 3, true);
+        cv::approxPolyDP(_contours.view(i), contourCurves[i], 3, true);
         _boundings[i] = cv::boundingRect(cv::Mat(contourCurves[i]));
 #else
-        _boundings[i] = cv::boundingRect(cv::Mat(_contours[i]));
+        _boundings[i] = cv::boundingRect(_contours.view(i));
 #endif//SD_APPROX_CURVES
-    }//for(ContourVector::size_type i = 0; i < contourSize; ++i)
+    }//for(int i = 0; i < contourSize; ++i)
 }//buildBoundings
 
 //-------------------------
@@ -403,18 +646,138 @@ void ContourManager::buildBoundings(const ContourVector & _contours, RectVector
  * \brief buildMassCenters Use this function to retrieve the mass centers of _contours.
  * \param _contours Input contours.
  * \param _massCenters Output mass centers.
+ * \param _areas Output contour areas.
  */
-void ContourManager::buildMassCenters(const ContourVector & _contours, PointVector & _massCenters)
+void ContourManager::buildMassCenters(const ContourStore & _contours, PointVector & _massCenters, std::vector<int> & _areas)
 {
-    ContourVector::size_type contourSize = _contours.size();
+    int contourSize = _contours.size();
     _massCenters.resize(contourSize);
+    _areas.resize(contourSize);
 
-    for (ContourVector::size_type i = 0; i < contourSize; ++i)
+    for (int i = 0; i < contourSize; ++i)
     {
-        massCenter(_contours[i],_massCenters[i]);
-    }//for(ContourVector::size_type i = 0; i < contourSize; ++i)
+        cv::Moments moments = cv::moments(_contours.view(i));
+
+        _massCenters[i].x = lround(moments.m10/moments.m00);
+        _massCenters[i].y = lround(moments.m01/moments.m00);
+        _areas[i] = qRound(moments.m00);
+    }//for (int i = 0; i < contourSize; ++i)
 }//buildMassCenters
 
 //-------------------------
 
+/*!
+ * \brief ContourManager::buildComponents Labels 8-connected components of _mat in one pass. Same connectivity as
+ *        findContours, but components inside holes of other ones are kept, and mass centers are pixel based.
+ *        Multi channel images are converted and thresholded first, single channel ones are used as is.
+ *        With EM_RUNS, the mask is run-length encoded first, then labeled run by run.
+ * \param _mat Input image.
+ * \param _flags SFHierarchy is ignored.
+ */
+void ContourManager::buildComponents(const Mat & _mat, SelectionFlags _flags)
+{
+    const Mat * pMask = &_mat;
+
+    if (m_inputFormat != IF_BINARY && _mat.channels() != 1)
+    {
+        prepareContourSearch(m_originalMat,m_binThresh,m_grayMat,m_contourMat);
+        pMask = &m_contourMat;
+    }//if (m_inputFormat != IF_BINARY && _mat.channels() != 1)
+
+    if (m_extractionMethod == EM_RUNS)
+    {
+        m_runMask.encode(*pMask);
+        m_labeler.process(m_runMask,m_components);
+    }//if (m_extractionMethod == EM_RUNS)
+    else
+    {
+        m_labeler.process(*pMask,m_components);
+    }//if (m_extractionMethod == EM_RUNS)...else
+
+    keepComponents(_flags);
+}//buildComponents
+
+//-------------------------
+
+/*!
+ * \brief ContourManager::keepComponents Copies attributes of labeled components that are not noise.
+ * \param _flags SFHierarchy is ignored.
+ */
+void ContourManager::keepComponents(SelectionFlags _flags)
+{
+    ComponentLabeler::ComponentVector::size_type componentCount = m_components.size();
+
+    m_tempAreas.resize(componentCount);
+    if (_flags & SFBoundings) m_tempBoundings.resize(componentCount);
+    if (_flags & SFMassCenters) m_tempMassCenters.resize(componentCount);
+
+    bool noiseLimits = hasNoiseLimits();
+    ComponentLabeler::ComponentVector::size_type keptCount = 0;
+
+    for (ComponentLabeler::ComponentVector::size_type i = 0; i < componentCount; ++i)
+    {
+        const ComponentLabeler::Component & component = m_components[i];
+
+        if (noiseLimits && isNoise(component.bounding,component.area)) continue;
+
+        m_tempAreas[keptCount] = component.area;
+        if (_flags & SFBoundings) m_tempBoundings[keptCount] = component.bounding;
+        if (_flags & SFMassCenters) m_tempMassCenters[keptCount] = component.massCenter;
+        ++keptCount;
+    }//for (ComponentLabeler::ComponentVector::size_type i = 0; i < componentCount; ++i)
+
+    m_droppedCount = static_cast<int>(componentCount - keptCount);
+
+    m_tempAreas.resize(keptCount);
+    if (_flags & SFBoundings) m_tempBoundings.resize(keptCount);
+    if (_flags & SFMassCenters) m_tempMassCenters.resize(keptCount);
+}//keepComponents
+
+//-------------------------
+
+bool ContourManager::hasNoiseLimits() const
+{
+    return (m_minSize.width > 0 || m_minSize.height > 0 || m_minArea > 0);
+}//hasNoiseLimits
+
+//-------------------------
+
+/// Returns true if a shape with the given bounding rect and area is below noise limits.
+bool ContourManager::isNoise(const Rect & _bounding, int _area) const
+{
+    return (_bounding.width < m_minSize.width || _bounding.height < m_minSize.height || _area < m_minArea);
+}//isNoise
+
+//-------------------------
+
+/*!
+ * \brief ContourManager::rejectNoise Removes contours below noise limits from the contour store, before boundings and
+ *        mass centers are computed. Area is only computed when the bounding rect passes.
+ */
+void ContourManager::rejectNoise()
+{
+    if (!hasNoiseLimits()) return;
+
+    int contourCount = m_contourStore.size();
+
+    m_keptContours.resize(contourCount);
+
+    for (int i = 0; i < contourCount; ++i)
+    {
+        Mat contour = m_contourStore.view(i);
+        Rect bounding = cv::boundingRect(contour);
+
+        bool noise = isNoise(bounding,m_minArea);//Size only
+
+        if (!noise && m_minArea > 0) noise = isNoise(bounding,qRound(cv::contourArea(contour)));
+
+        m_keptContours[i] = noise ? 0 : 1;
+        if (noise) ++m_droppedCount;
+    }//for (int i = 0; i < contourCount; ++i)
+
+    if (m_droppedCount) m_contourStore.compact(m_keptContours);
+}//rejectNoise
+
+//-------------------------
+
 }//namespace SubDetection
@@ -23,6 +23,10 @@
 #include "subdetection_global.h"
 
 #include "types.h"
+#include "childindextable.h"
+#include "componentlabeler.h"
+#include "componenttable.h"
+#include "contourstore.h"
 
 namespace SubDetection
 {
@@ -40,8 +44,24 @@ public:
 
     Q_DECLARE_FLAGS(SelectionFlags,SelectionFlag);
 
+    /// How shapes are extracted from the image
+    enum ExtractionMethod
+    {
+        EM_CONTOURS,///< Gray conversion, threshold then cv::findContours (default)
+        EM_COMPONENTS,///< Single pass 8-connected component labeling. No contour nor hierarchy: boundings, areas and mass centers only.
+        EM_RUNS///< Same components as EM_COMPONENTS, labeled on a run-length encoded mask. Faster on sparse masks.
+    };//ExtractionMethod
+
+    /// What the image given to "process" contains
+    enum InputFormat
+    {
+        IF_COLOR,///< Color image: converted to gray then thresholded with the binarization thresh (default)
+        IF_BINARY///< CV_8UC1 mask: every non null pixel is foreground. No conversion nor threshold.
+    };//InputFormat
+
     static void children(const Hierarchy & _hierarchy, int _parentIndex, IndexVector & _children);
     static void children(const ContourVector & _contours, const Hierarchy & _hierarchy, int _parentIndex, ContourVector & _children);
+    static void children(const ContourStore & _contours, const Hierarchy & _hierarchy, int _parentIndex, ContourVector & _children);
     static int childCount(const Hierarchy & _hierarchy, int _parentIndex);
     static void massCenter(const Contour & _contour, Point & _massCenter);
 
@@ -68,24 +88,58 @@ public:
 
     void setHierarchySearch(bool _enabled);
 
+    void setExtractionMethod(ExtractionMethod _method);
+    ExtractionMethod extractionMethod() const {return m_extractionMethod;}
+
+    void setNoiseLimits(const Size & _minSize, int _minArea);
+    /// Returns the number of shapes dropped by noise limits during last call to "process".
+    int droppedCount() const {return m_droppedCount;}
+
+    void setMaxThreads(int _maxThreads);
+    /// Returns the maximum number of mask bands labeled at the same time with EM_COMPONENTS.
+    int maxThreads() const {return m_labeler.maxThreads();}
+
+    void enableIncrementalLabeling(bool _enabled);
+
     void contours(ContourVector & _contours) const;
     void contours(ContourVector & _contours, Hierarchy & _hierarchy) const;
     void boundingRects(RectVector & _boundings) const;
     void massCenters(PointVector & _massCenters) const;
+    void areas(std::vector<int> & _areas) const;
+    void components(ComponentTable & _components) const;
 
     void attributes(Attributes & _attributes) const;
+    void takeAttributes(Attributes & _attributes);
+
+    /// Last computed items, valid until next call to "process" or "takeAttributes".
+    const ContourVector & contours() const;
+    const ContourStore & contourStore() const {return m_contourStore;}
+    const Hierarchy & hierarchy() const {return m_tempHierarchy;}
+    /// Children of each contour, built with SFHierarchy.
+    const ChildIndexTable & childTable() const {return m_childTable;}
+    const RectVector & boundingRects() const {return m_tempBoundings;}
+    const PointVector & massCenters() const {return m_tempMassCenters;}
+    const std::vector<int> & areas() const {return m_tempAreas;}
 
     void process(Mat & _mat, SelectionFlags _flags);
     void process(const Mat & _mat, SelectionFlags _flags);
+    void process(const Mat & _mat, InputFormat _format, SelectionFlags _flags);
+    void process(const RleMask & _runs, SelectionFlags _flags);
 
 protected:
     void setImage(Mat & _mat);
 //    void setImage(const Mat & _mat);
 
-    void buildContours(ContourVector & _contours);
-    void buildContours(ContourVector & _contours, Hierarchy &_hierarchy);
-    void buildBoundings(const ContourVector & _contours, RectVector & _boundings);
-    void buildMassCenters(const ContourVector & _contours, PointVector & _massCenters);
+    void prepareImage();
+    void buildContours();
+    void buildContours(Hierarchy & _hierarchy);
+    void buildBoundings(const ContourStore & _contours, RectVector & _boundings);
+    void buildMassCenters(const ContourStore & _contours, PointVector & _massCenters, std::vector<int> & _areas);
+    void buildComponents(const Mat & _mat, SelectionFlags _flags);
+    void keepComponents(SelectionFlags _flags);
+    bool hasNoiseLimits() const;
+    bool isNoise(const Rect & _bounding, int _area) const;
+    void rejectNoise();
 
     typedef quint32 Flag;
 
@@ -94,14 +148,29 @@ protected:
     int m_cvRetrievalMode;
     int m_cvApproxMethod;
 
+    ExtractionMethod m_extractionMethod;
+    InputFormat m_inputFormat;///< Format of the image being processed.
+    ComponentLabeler m_labeler;
+    ComponentLabeler::ComponentVector m_components;
+    RleMask m_runMask;///< Mask encoded with EM_RUNS.
+
+    Size m_minSize;///< Noise limit. See setNoiseLimits.
+    int m_minArea;///< Noise limit. See setNoiseLimits.
+    int m_droppedCount;
+    std::vector<uchar> m_keptContours;
+
     Mat m_originalMat;
     Mat m_grayMat;
     Mat m_contourMat;
 
-    ContourVector m_tempContours;
+    ContourStore m_contourStore;
+    mutable ContourVector m_tempContours;///< Copy of m_contourStore, made on demand.
+    mutable bool m_contoursCopied;
     RectVector m_tempBoundings;
     PointVector m_tempMassCenters;
     Hierarchy m_tempHierarchy;
+    ChildIndexTable m_childTable;
+    std::vector<int> m_tempAreas;
 
     SelectionFlags m_lastFlags;
 };//ContourManager
@@ -0,0 +1,229 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "contourrasterizer.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+/// Returns the smallest integer not below _numerator / _denominator. _denominator must be positive.
+inline int ceilDivision(int _numerator, int _denominator)
+{
+    return (_numerator >= 0) ? (_numerator + _denominator - 1) / _denominator : -((-_numerator) / _denominator);
+}//ceilDivision
+}//namespace
+
+ContourRasterizer::ContourRasterizer()
+{
+}//ContourRasterizer
+
+//-------------------------
+
+/*!
+ * \brief ContourRasterizer::reset Defines the area to locate, every pixel being outside. Buffers are kept.
+ * \param _area Area in original Mat coordinates.
+ */
+void ContourRasterizer::reset(const Rect & _area)
+{
+    m_area = _area;
+
+    m_locations.create(m_area.height,m_area.width,CV_8UC1);
+    m_locations.setTo(Scalar::all(L_OUTSIDE));
+}//reset
+
+//-------------------------
+
+/*!
+ * \brief ContourRasterizer::setContour Locates area pixels regarding the outer contour. Call once, after reset.
+ * \param _pPoints Closed contour points, in original Mat coordinates.
+ * \param _count Number of points.
+ */
+void ContourRasterizer::setContour(const Point * _pPoints, int _count)
+{
+    paint(_pPoints,_count,L_OUTSIDE,L_INSIDE,L_EDGE);
+}//setContour
+
+//-------------------------
+
+/*!
+ * \brief ContourRasterizer::addHole Pixels inside the contour and inside or on the edge of the hole become L_HOLE.
+ *        Call after setContour, once per hole.
+ * \param _pPoints Closed hole contour points, in original Mat coordinates.
+ * \param _count Number of points.
+ */
+void ContourRasterizer::addHole(const Point * _pPoints, int _count)
+{
+    paint(_pPoints,_count,L_INSIDE,L_HOLE,L_HOLE);
+}//addHole
+
+//-------------------------
+
+/*!
+ * \brief ContourRasterizer::paint Pixels labeled _from strictly inside the contour are labeled _inside, then pixels
+ *        labeled _from or _inside on contour segments are labeled _edge.
+ */
+void ContourRasterizer::paint(const Point * _pPoints, int _count, uchar _from, uchar _inside, uchar _edge)
+{
+    if (_count <= 0 || m_area.width <= 0 || m_area.height <= 0) return;
+
+    int left = m_area.x;
+    int right = m_area.x + m_area.width;
+
+    fillCrossings(_pPoints,_count);
+
+    //Even-odd rule: a pixel is inside when an odd number of crossings lie right of it
+    for (int row = 0; row < m_area.height; ++row)
+    {
+        int * pFirst = &m_crossings[0] + m_rowOffsets[row];
+        int * pLast = &m_crossings[0] + m_rowOffsets[row + 1];
+
+        std::sort(pFirst,pLast);
+
+        uchar * pLocations = m_locations.ptr<uchar>(row);
+        int crossingCount = static_cast<int>(pLast - pFirst);
+
+        for (int i = crossingCount - 1; i >= 0; i -= 2)
+        {
+            int first = (i > 0) ? std::max(pFirst[i - 1],left) : left;
+            int last = std::min(pFirst[i],right);
+
+            for (int x = first; x < last; ++x)
+            {
+                if (pLocations[x - left] == _from) pLocations[x - left] = _inside;
+            }//for (int x = first; x < last; ++x)
+        }//for (int i = crossingCount - 1; i >= 0; i -= 2)
+    }//for (int row = 0; row < m_area.height; ++row)
+
+    //Integer points of each segment
+    int top = m_area.y;
+    int bottom = m_area.y + m_area.height;
+
+    for (int i = 0; i < _count; ++i)
+    {
+        const Point & first = _pPoints[i];
+        const Point & second = _pPoints[(i + 1) % _count];
+
+        if (first.y == second.y)
+        {
+            if (first.y < top || first.y >= bottom) continue;
+
+            uchar * pLocations = m_locations.ptr<uchar>(first.y - top);
+            int firstX = std::max(std::min(first.x,second.x),left);
+            int lastX = std::min(std::max(first.x,second.x) + 1,right);
+
+            for (int x = firstX; x < lastX; ++x)
+            {
+                uchar & location = pLocations[x - left];
+
+                if (location == _from || location == _inside) location = _edge;
+            }//for (int x = firstX; x < lastX; ++x)
+
+            continue;
+        }//if (first.y == second.y)
+
+        int deltaX = second.x - first.x;
+        int deltaY = second.y - first.y;
+        int firstY = std::max(std::min(first.y,second.y),top);
+        int lastY = std::min(std::max(first.y,second.y) + 1,bottom);
+
+        for (int y = firstY; y < lastY; ++y)
+        {
+            int numerator = (y - first.y) * deltaX;
+
+            if (numerator % deltaY) continue;
+
+            int x = first.x + numerator / deltaY;
+
+            if (x < left || x >= right) continue;
+
+            uchar & location = m_locations.at<uchar>(y - top,x - left);
+
+            if (location == _from || location == _inside) location = _edge;
+        }//for (int y = firstY; y < lastY; ++y)
+    }//for (int i = 0; i < _count; ++i)
+}//paint
+
+//-------------------------
+
+/*!
+ * \brief ContourRasterizer::fillCrossings Lists, for each area row, where non horizontal segments cross it.
+ *        As in pointPolygonTest, a segment crosses row y when y is in [lower end, upper end[, and a pixel is counted
+ *        left of the crossing when its column is strictly lower than the crossing abscissa: the stored value is that
+ *        abscissa rounded up.
+ */
+void ContourRasterizer::fillCrossings(const Point * _pPoints, int _count)
+{
+    int top = m_area.y;
+    int bottom = m_area.y + m_area.height;
+
+    m_rowOffsets.assign(m_area.height + 1,0);
+
+    //Counting crossings of each row first
+    for (int i = 0; i < _count; ++i)
+    {
+        const Point & first = _pPoints[i];
+        const Point & second = _pPoints[(i + 1) % _count];
+
+        if (first.y == second.y) continue;
+
+        int firstY = std::max(std::min(first.y,second.y),top);
+        int lastY = std::min(std::max(first.y,second.y),bottom);
+
+        for (int y = firstY; y < lastY; ++y)
+        {
+            ++m_rowOffsets[y - top + 1];
+        }//for (int y = firstY; y < lastY; ++y)
+    }//for (int i = 0; i < _count; ++i)
+
+    for (int row = 0; row < m_area.height; ++row)
+    {
+        m_rowOffsets[row + 1] += m_rowOffsets[row];
+    }//for (int row = 0; row < m_area.height; ++row)
+
+    m_crossings.resize(m_rowOffsets[m_area.height] + 1);//Never empty: first crossing address is always valid
+
+    m_nextCrossings.assign(m_rowOffsets.begin(),m_rowOffsets.end() - 1);
+
+    for (int i = 0; i < _count; ++i)
+    {
+        const Point & first = _pPoints[i];
+        const Point & second = _pPoints[(i + 1) % _count];
+
+        if (first.y == second.y) continue;
+
+        int deltaX = second.x - first.x;
+        int deltaY = second.y - first.y;
+        int sign = (deltaY > 0) ? 1 : -1;
+        int firstY = std::max(std::min(first.y,second.y),top);
+        int lastY = std::min(std::max(first.y,second.y),bottom);
+
+        for (int y = firstY; y < lastY; ++y)
+        {
+            m_crossings[m_nextCrossings[y - top]++] = first.x + ceilDivision(sign * (y - first.y) * deltaX,sign * deltaY);
+        }//for (int y = firstY; y < lastY; ++y)
+    }//for (int i = 0; i < _count; ++i)
+}//fillCrossings
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,77 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_CONTOURRASTERIZER_H
+#define SUBDETECTION_CONTOURRASTERIZER_H
+
+#include <vector>
+
+#include "subdetection_global.h"
+
+#include "types.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The ContourRasterizer class. Locates every pixel of an area regarding a contour and its holes at once,
+ *        with a scanline fill: cost grows with area plus contour lengths, instead of their product.
+ *        Locations are the same as cv::pointPolygonTest on integer contours: even-odd rule, and a pixel lying
+ *        on a contour segment is on its edge.
+ */
+class SUBDETECTIONSHARED_EXPORT ContourRasterizer
+{
+public:
+    /// Pixel location regarding the contour.
+    enum Location
+    {
+        L_OUTSIDE = 0,///< pointPolygonTest < 0 with the contour.
+        L_INSIDE,///< pointPolygonTest > 0 with the contour, < 0 with every hole.
+        L_EDGE,///< pointPolygonTest == 0 with the contour.
+        L_HOLE///< pointPolygonTest > 0 with the contour, >= 0 with a hole.
+    };//Location
+
+    ContourRasterizer();
+
+    void reset(const Rect & _area);
+    void setContour(const Point * _pPoints, int _count);
+    void addHole(const Point * _pPoints, int _count);
+
+    /// Returns the area passed to reset.
+    const Rect & area() const {return m_area;}
+    /// Returns the location of a pixel of the area, in original Mat coordinates. No control is made.
+    Location location(int _x, int _y) const {return static_cast<Location>(m_locations.at<uchar>(_y - m_area.y,_x - m_area.x));}
+    /// Returns area locations, one byte per pixel. See Location.
+    const Mat & locations() const {return m_locations;}
+
+protected:
+    void paint(const Point * _pPoints, int _count, uchar _from, uchar _inside, uchar _edge);
+    void fillCrossings(const Point * _pPoints, int _count);
+
+    Rect m_area;
+    Mat m_locations;
+
+    std::vector<int> m_rowOffsets;///< Index of the first crossing of each area row, plus the total crossing count.
+    std::vector<int> m_crossings;///< Smallest column right of each edge crossing, row after row.
+    std::vector<int> m_nextCrossings;///< Next crossing index of each row while filling.
+};//ContourRasterizer
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_CONTOURRASTERIZER_H
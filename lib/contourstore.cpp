@@ -0,0 +1,224 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include <opencv2/core/core_c.h>
+#include <opencv2/imgproc/imgproc_c.h>
+
+#include "contourstore.h"
+
+namespace SubDetection
+{
+
+ContourStore::ContourStore():
+    m_offsets(1,0),
+    m_pStorage(0)
+{
+}//ContourStore
+
+//-------------------------
+
+/*! Points are copied. OpenCV storage is not: each store creates its own.*/
+ContourStore::ContourStore(const ContourStore & _other):
+    m_points(_other.m_points),
+    m_offsets(_other.m_offsets),
+    m_pStorage(0)
+{
+}//ContourStore const ContourStore
+
+//-------------------------
+
+ContourStore::~ContourStore()
+{
+    if (m_pStorage) cvReleaseMemStorage(&m_pStorage);
+}//~ContourStore
+
+//-------------------------
+
+ContourStore & ContourStore::operator=(const ContourStore & _other)
+{
+    m_points = _other.m_points;
+    m_offsets = _other.m_offsets;
+
+    return *this;
+}//operator=
+
+//-------------------------
+
+/*!
+ * \brief ContourStore::find Same as cv::findContours, without hierarchy. Previous contours are dropped.
+ * \param _image Input CV_8UC1 image. Modified by OpenCV.
+ * \param _cvRetrievalMode OpenCV contour retrieval mode. See OpenCV documentation on findContours for more details.
+ * \param _cvApproxMethod OpenCV contour approximation method. See OpenCV documentation on findContours for more details.
+ */
+void ContourStore::find(Mat & _image, int _cvRetrievalMode, int _cvApproxMethod)
+{
+    find(_image,0,_cvRetrievalMode,_cvApproxMethod);
+}//find
+
+//-------------------------
+
+/*!
+ * \brief ContourStore::find Same as cv::findContours. Previous contours are dropped.
+ * \param _hierarchy Output hierarchy, same as cv::findContours one.
+ */
+void ContourStore::find(Mat & _image, Hierarchy & _hierarchy, int _cvRetrievalMode, int _cvApproxMethod)
+{
+    find(_image,&_hierarchy,_cvRetrievalMode,_cvApproxMethod);
+}//find Hierarchy
+
+//-------------------------
+
+void ContourStore::clear()
+{
+    m_points.clear();
+    m_offsets.assign(1,0);
+}//clear
+
+//-------------------------
+
+/*!
+ * \brief ContourStore::compact Removes contours whose flag is null in _kept, in place. Kept contours stay in the same order.
+ *        A hierarchy found with the contours no longer matches them afterwards.
+ * \param _kept One flag per contour. No control is made.
+ */
+void ContourStore::compact(const std::vector<uchar> & _kept)
+{
+    int contourCount = size();
+    int keptCount = 0;
+    int pointCount = 0;
+
+    for (int i = 0; i < contourCount; ++i)
+    {
+        if (!_kept[i]) continue;
+
+        int first = m_offsets[i];
+        int contourLength = m_offsets[i + 1] - first;
+
+        //Moving down: destination never overlaps an unread contour
+        if (first != pointCount) std::copy(m_points.begin() + first,m_points.begin() + first + contourLength,m_points.begin() + pointCount);
+
+        m_offsets[keptCount] = pointCount;
+        pointCount += contourLength;
+        ++keptCount;
+    }//for (int i = 0; i < contourCount; ++i)
+
+    m_offsets[keptCount] = pointCount;
+    m_offsets.resize(keptCount + 1);
+    m_points.resize(pointCount);
+}//compact
+
+//-------------------------
+
+/*!
+ * \brief ContourStore::view Returns a Nx1 CV_32SC2 Mat header on contour _index points. No copy is made: it is valid
+ *        until next call to "find" or "clear". No control is made.
+ */
+Mat ContourStore::view(int _index) const
+{
+    return Mat(length(_index),1,CV_32SC2,const_cast<Point *>(points(_index)));
+}//view
+
+//-------------------------
+
+/*!
+ * \brief ContourStore::contour Copies contour _index points into _contour. No control is made.
+ */
+void ContourStore::contour(int _index, Contour & _contour) const
+{
+    _contour.assign(points(_index),points(_index) + length(_index));
+}//contour
+
+//-------------------------
+
+/*!
+ * \brief ContourStore::contours Copies all contours into _contours, in the same order as cv::findContours.
+ */
+void ContourStore::contours(ContourVector & _contours) const
+{
+    int contourCount = size();
+
+    _contours.resize(contourCount);
+
+    for (int i = 0; i < contourCount; ++i)
+    {
+        contour(i,_contours[i]);
+    }//for (int i = 0; i < contourCount; ++i)
+}//contours
+
+//-------------------------
+
+/*!
+ * \brief ContourStore::find Runs cvFindContours on the reused storage, then copies contours in the same order
+ *        as cv::findContours. Hierarchy is built the same way, if _pHierarchy is not null.
+ */
+void ContourStore::find(Mat & _image, Hierarchy * _pHierarchy, int _cvRetrievalMode, int _cvApproxMethod)
+{
+    clear();
+    if (_pHierarchy) _pHierarchy->clear();
+
+    if (m_pStorage)
+        cvClearMemStorage(m_pStorage);//Memory blocks are kept
+    else
+        m_pStorage = cvCreateMemStorage(0);
+
+    CvMat image = _image;
+    CvSeq * pFirstContour = 0;
+
+    cvFindContours(&image,m_pStorage,&pFirstContour,sizeof(CvContour),_cvRetrievalMode,_cvApproxMethod,cvPoint(0,0));
+
+    if (!pFirstContour) return;
+
+    CvSeq * pAllContours = cvTreeToNodeSeq(pFirstContour,sizeof(CvSeq),m_pStorage);
+    int contourCount = pAllContours->total;
+
+    m_offsets.resize(contourCount + 1);
+
+    for (int i = 0; i < contourCount; ++i)
+    {
+        CvSeq * pContour = *CV_GET_SEQ_ELEM(CvSeq *,pAllContours,i);
+
+        reinterpret_cast<CvContour *>(pContour)->color = i;//Index lookup when building hierarchy
+        m_offsets[i + 1] = m_offsets[i] + pContour->total;
+    }//for (int i = 0; i < contourCount; ++i)
+
+    m_points.resize(m_offsets[contourCount]);
+
+    if (_pHierarchy) _pHierarchy->resize(contourCount);
+
+    for (int i = 0; i < contourCount; ++i)
+    {
+        CvSeq * pContour = *CV_GET_SEQ_ELEM(CvSeq *,pAllContours,i);
+
+        cvCvtSeqToArray(pContour,&m_points[m_offsets[i]],CV_WHOLE_SEQ);
+
+        if (_pHierarchy)
+        {
+            (*_pHierarchy)[i] = HierarchyItem(pContour->h_next ? reinterpret_cast<CvContour *>(pContour->h_next)->color : -1,
+                                              pContour->h_prev ? reinterpret_cast<CvContour *>(pContour->h_prev)->color : -1,
+                                              pContour->v_next ? reinterpret_cast<CvContour *>(pContour->v_next)->color : -1,
+                                              pContour->v_prev ? reinterpret_cast<CvContour *>(pContour->v_prev)->color : -1);
+        }//if (_pHierarchy)
+    }//for (int i = 0; i < contourCount; ++i)
+}//find Hierarchy pointer
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,78 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_CONTOURSTORE_H
+#define SUBDETECTION_CONTOURSTORE_H
+
+#include "subdetection_global.h"
+
+#include "types.h"
+
+struct CvMemStorage;
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The ContourStore class. Contours found by cv::findContours, kept in a single point buffer.
+ *        Buffers and OpenCV storage are reused from one call to "find" to the next: once they are big enough,
+ *        no allocation is made. Contours are read through "points" and "length", or "view" for OpenCV functions
+ *        taking a contour (boundingRect, moments, pointPolygonTest...).
+ */
+class SUBDETECTIONSHARED_EXPORT ContourStore
+{
+public:
+    ContourStore();
+    ContourStore(const ContourStore & _other);
+    ~ContourStore();
+
+    ContourStore & operator=(const ContourStore & _other);
+
+    void find(Mat & _image, int _cvRetrievalMode, int _cvApproxMethod);
+    void find(Mat & _image, Hierarchy & _hierarchy, int _cvRetrievalMode, int _cvApproxMethod);
+
+    void clear();
+    void compact(const std::vector<uchar> & _kept);
+
+    /// Returns the number of contours.
+    int size() const {return static_cast<int>(m_offsets.size()) - 1;}
+    bool isEmpty() const {return size() == 0;}
+
+    /// Returns the first point of contour _index. No control is made.
+    const Point * points(int _index) const {return &m_points[m_offsets[_index]];}
+    /// Returns the number of points of contour _index. No control is made.
+    int length(int _index) const {return m_offsets[_index + 1] - m_offsets[_index];}
+
+    Mat view(int _index) const;
+
+    void contour(int _index, Contour & _contour) const;
+    void contours(ContourVector & _contours) const;
+
+protected:
+    void find(Mat & _image, Hierarchy * _pHierarchy, int _cvRetrievalMode, int _cvApproxMethod);
+
+    PointVector m_points;///< Points of all contours, one after the other.
+    std::vector<int> m_offsets;///< Index of the first point of each contour in m_points, plus total point count.
+
+    CvMemStorage * m_pStorage;///< Created on first search.
+};//ContourStore
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_CONTOURSTORE_H
@@ -0,0 +1,63 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "detectioncontext.h"
+
+namespace SubDetection
+{
+
+DetectionContext::DetectionContext():
+    m_forget(true),
+    m_settingsVersion(0),
+    m_linesDecoded(false)
+{
+}//DetectionContext
+
+//-------------------------
+
+/*!
+ * \brief DetectionContext::forget Forgets previous detection: next image is analyzed as if it was the first one.
+ */
+void DetectionContext::forget()
+{
+    m_forget = true;
+
+    m_textLines.clear();
+}//forget
+
+//-------------------------
+
+/*!
+ * \brief DetectionContext::textBoundingRects After a detection, populates _rects with the text line rects, in original Mat coordinates.
+ * \param _rects Output rect list.
+ */
+void DetectionContext::textBoundingRects(RectVector & _rects) const
+{
+    RectVector::size_type rectCount = m_boundingRects.size();
+    _rects.resize(rectCount);
+
+    for (RectVector::size_type i = 0; i < rectCount; ++i)
+    {
+        _rects[i] = m_boundingRects[i] + m_workOffset;
+    }//for (RectVector::size_type i = 0; i < rectCount; ++i)
+}//textBoundingRects
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,132 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_DETECTIONCONTEXT_H
+#define SUBDETECTION_DETECTIONCONTEXT_H
+
+#include <vector>
+
+#include <QString>
+
+#include "subdetection_global.h"
+
+#include "types.h"
+#include "contourmanager.h"
+#include "packedmask.h"
+#include "projectionlinefinder.h"
+#include "rlemask.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The DetectionContext class. Scratch buffers and history of one image stream, used by Detector.
+ *        A configured Detector is not modified by detection: several threads can share it, each one
+ *        with its own context. A context must not be used by two threads at the same time.
+ */
+class SUBDETECTIONSHARED_EXPORT DetectionContext
+{
+public:
+    /// Text line recognized on last change.
+    struct TextLine
+    {
+        PackedMask bits;///< Line mask.
+        QString text;///< Recognized text.
+    };//TextLine
+
+    typedef std::vector<TextLine> TextLineVector;
+
+    /// Shapes dropped by each filtering stage of last line search. Helps tuning noise limits and charMaxSize.
+    struct FilterStatistics
+    {
+        FilterStatistics(): shapeCount(0), noiseCount(0), zoneCount(0), rejectedLineCount(0) {}
+
+        int shapeCount;///< Shapes extracted from the mask, noise included.
+        int noiseCount;///< Dropped at extraction: below charMinSize or charMinArea.
+        int zoneCount;///< Dropped before grouping: mass center out of zone, or bigger than charMaxSize.
+        int rejectedLineCount;///< Lines dropped after grouping: too few characters or too small.
+    };//FilterStatistics
+
+    DetectionContext();
+
+    void forget();
+
+    /// After a detection, returns the HSV representation of the original Mat. Zone sized if zone processing is enabled. Empty with MM_LOOKUP_TABLE.
+    const Mat & hsvMat() const {return m_hsvMat;}
+    /// After a detection, returns the thresholded representation of the original Mat regarding HSV parameters. Zone sized if zone processing is enabled.
+    /// When masking straight into runs (MM_LOOKUP_TABLE with ContourManager::EM_RUNS), only text lines of last change are written.
+    const Mat & thresholdedMat() const {return m_threshMat;}
+    /// After a detection, returns only the desired colors in the original Mat regarding HSV parameters. Zone sized if zone processing is enabled.
+    const Mat & maskedMat() const {return m_maskedMat;}
+    /// After a detection, returns the thresholded text zone of the orignal Mat regarding HSV parameters. Empty when masking straight into runs.
+    const Mat & textZoneMat() const {return m_textZoneMat;}
+    /// After a detection, returns an image with contours of the orignal Mat regarding HSV parameters.
+    const Mat & contoursMat() const {return m_contourMat;}
+    /// After a detection, returns an image containing text zone and blob boundings. Zone sized after detectZone.
+    const Mat & boundingsMat() const {return m_boundingsMat;}
+
+    void textBoundingRects(RectVector & _rects) const;
+
+    /// Packed text zone saved on last change: the reference next images are compared with.
+    const PackedMask & referenceTextZoneBits() const {return m_oldTextZoneBits;}
+
+    /// After a detection, returns what each filtering stage dropped. Zero when lines were found without contours.
+    const FilterStatistics & filterStatistics() const {return m_filterStatistics;}
+
+protected:
+    friend class Detector;
+
+    Mat m_originalMat;
+    Mat m_workMat;///< Mat the detection works on: original Mat or its text zone.
+    Mat m_hsvMat;
+    Mat m_threshMat;
+    Mat m_textZoneMat;
+    Mat m_oldTextZoneMat;
+    Mat m_maskedMat;
+    Mat m_grayMat;
+    Mat m_contourMat;
+    Mat m_boundingsMat;
+
+    RectVector m_boundingRects;///< Text rects in m_workMat coordinates.
+
+    Rect m_workZone;///< Text zone in m_workMat coordinates.
+    Point m_workOffset;///< m_workMat origin in original image coordinates.
+    Point m_originalOffset;///< m_originalMat origin in original image coordinates. Zone top left with detectZone.
+
+    TextLineVector m_textLines;
+
+    FilterStatistics m_filterStatistics;
+
+    ContourManager m_contourManager;
+    ProjectionLineFinder m_lineFinder;
+
+    bool m_forget;
+    int m_settingsVersion;///< Detector settings the history was built with.
+
+    PackedMask m_textZoneBits;
+    PackedMask m_oldTextZoneBits;
+
+    RleMask m_runMask;///< Work Mat mask, when masked straight into runs. Empty otherwise.
+    RectVector m_decodedLineRects;///< Rects of m_threshMat written by Detector::decodeTextLines. Valid if m_linesDecoded.
+    bool m_linesDecoded;///< m_threshMat is null outside m_decodedLineRects. Reset whenever m_threshMat is written otherwise.
+};//DetectionContext
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_DETECTIONCONTEXT_H
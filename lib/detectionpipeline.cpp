@@ -0,0 +1,344 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QThread>
+
+#include "deepdebug.h"
+
+#include "detectionpipeline.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The DetectionStage class. Thread applying one Detector step, with its own context, to every frame of its input queue.
+ *        A null frame marks the end of the stream: it is forwarded, then the thread ends.
+ */
+class DetectionStage : public QThread
+{
+public:
+    typedef void (Detector::*Step)(Detector::Frame &, DetectionContext &) const;
+    typedef SpscQueue<DetectionPipeline::FramePtr> FrameQueue;
+
+    DetectionStage(const Detector & _detector, DetectionContext & _context, Step _step, FrameQueue & _input, FrameQueue & _output):
+        m_detector(_detector),
+        m_context(_context),
+        m_step(_step),
+        m_input(_input),
+        m_output(_output)
+    {
+    }//DetectionStage
+
+protected:
+    void run()
+    {
+        DetectionPipeline::FramePtr pFrame;
+
+        do
+        {
+            m_input.pop(pFrame);
+
+            if (pFrame) (m_detector.*m_step)(*pFrame,m_context);
+
+            m_output.push(pFrame);
+        } while (pFrame);
+    }//run
+
+    const Detector & m_detector;
+    DetectionContext & m_context;
+    Step m_step;
+
+    FrameQueue & m_input;
+    FrameQueue & m_output;
+};//DetectionStage
+
+//-------------------------
+
+/*!
+ * \brief DetectionPipeline::DetectionPipeline
+ * \param _pParams Detection parameters, shared by all stages. Must not be modified while the pipeline is running.
+ * \param _tessdataParentPath : tesseract "tessdata" parent directory.
+ * \param _lang : language. Be sure that corresponding language files are available in tessdata directory.
+ * \param _queueCapacity Maximum number of frames waiting between two stages.
+ */
+DetectionPipeline::DetectionPipeline(const QSharedPointer<Parameters> & _pParams, const QString & _tessdataParentPath, const QString & _lang,
+                                     int _queueCapacity):
+    m_detector(_pParams,_tessdataParentPath,_lang),
+    m_inputQueue(_queueCapacity),
+    m_maskedQueue(_queueCapacity),
+    m_linedQueue(_queueCapacity),
+    m_outputQueue(_queueCapacity),
+    m_running(false),
+    m_finished(false),
+    m_ended(false)
+{
+}//DetectionPipeline
+
+//-------------------------
+
+DetectionPipeline::~DetectionPipeline()
+{
+    stop();
+}//~DetectionPipeline
+
+//-------------------------
+
+void DetectionPipeline::setMaskingMethod(Detector::MaskingMethod _method)
+{
+    if (!canChangeSettings("setMaskingMethod")) return;
+
+    m_detector.setMaskingMethod(_method);
+}//setMaskingMethod
+
+//-------------------------
+
+void DetectionPipeline::setChangeDetectionMethod(Detector::ChangeDetectionMethod _method)
+{
+    if (!canChangeSettings("setChangeDetectionMethod")) return;
+
+    m_detector.setChangeDetectionMethod(_method);
+}//setChangeDetectionMethod
+
+//-------------------------
+
+void DetectionPipeline::setExtractionMethod(ContourManager::ExtractionMethod _method)
+{
+    if (!canChangeSettings("setExtractionMethod")) return;
+
+    m_detector.setExtractionMethod(_method);
+}//setExtractionMethod
+
+//-------------------------
+
+void DetectionPipeline::setContourInput(ContourManager::InputFormat _format)
+{
+    if (!canChangeSettings("setContourInput")) return;
+
+    m_detector.setContourInput(_format);
+}//setContourInput
+
+//-------------------------
+
+void DetectionPipeline::setLineFindingMethod(Detector::LineFindingMethod _method)
+{
+    if (!canChangeSettings("setLineFindingMethod")) return;
+
+    m_detector.setLineFindingMethod(_method);
+}//setLineFindingMethod
+
+//-------------------------
+
+void DetectionPipeline::enableZoneProcessing(bool _enabled)
+{
+    if (!canChangeSettings("enableZoneProcessing")) return;
+
+    m_detector.enableZoneProcessing(_enabled);
+}//enableZoneProcessing
+
+//-------------------------
+
+void DetectionPipeline::enableIncrementalRecognition(bool _enabled)
+{
+    if (!canChangeSettings("enableIncrementalRecognition")) return;
+
+    m_detector.enableIncrementalRecognition(_enabled);
+}//enableIncrementalRecognition
+
+//-------------------------
+
+void DetectionPipeline::enableIncrementalExtraction(bool _enabled)
+{
+    if (!canChangeSettings("enableIncrementalExtraction")) return;
+
+    m_detector.enableIncrementalExtraction(_enabled);
+}//enableIncrementalExtraction
+
+//-------------------------
+
+void DetectionPipeline::enableParallelRecognition(bool _enabled, int _maxThreads)
+{
+    if (!canChangeSettings("enableParallelRecognition")) return;
+
+    m_detector.enableParallelRecognition(_enabled,_maxThreads);
+}//enableParallelRecognition
+
+//-------------------------
+
+void DetectionPipeline::enableTiledProcessing(bool _enabled, int _maxThreads)
+{
+    if (!canChangeSettings("enableTiledProcessing")) return;
+
+    m_detector.enableTiledProcessing(_enabled,_maxThreads);
+}//enableTiledProcessing
+
+//-------------------------
+
+void DetectionPipeline::setOcrCache(const QSharedPointer<OcrCache> & _pCache)
+{
+    if (!canChangeSettings("setOcrCache")) return;
+
+    m_detector.setOcrCache(_pCache);
+}//setOcrCache
+
+//-------------------------
+
+void DetectionPipeline::setOcrEnginePool(const Detector::OcrEnginePoolPtr & _pPool)
+{
+    if (!canChangeSettings("setOcrEnginePool")) return;
+
+    m_detector.setOcrEnginePool(_pPool);
+}//setOcrEnginePool
+
+//-------------------------
+
+/*!
+ * \brief DetectionPipeline::canChangeSettings Returns false while stage threads are running: they read Detector settings.
+ * \param _setter Name of the calling setter, for debug output.
+ */
+bool DetectionPipeline::canChangeSettings(const char * _setter) const
+{
+    if (m_running)
+    {
+        deepDebug("DetectionPipeline::%s : settings cannot be changed while pipeline is running.",_setter);
+        return false;
+    }//if (m_running)
+
+    return true;
+}//canChangeSettings
+
+//-------------------------
+
+/*!
+ * \brief DetectionPipeline::start Starts stage threads. A pipeline can be started only once.
+ */
+void DetectionPipeline::start()
+{
+    if (m_running || m_ended) return;
+
+    m_stages.append(new DetectionStage(m_detector,m_maskContext,&Detector::maskStage,m_inputQueue,m_maskedQueue));
+    m_stages.append(new DetectionStage(m_detector,m_lineContext,&Detector::lineStage,m_maskedQueue,m_linedQueue));
+    m_stages.append(new DetectionStage(m_detector,m_recognitionContext,&Detector::recognitionStage,m_linedQueue,m_outputQueue));
+
+    for (int i = 0; i < m_stages.size(); ++i)
+    {
+        m_stages[i]->start();
+    }//for (int i = 0; i < m_stages.size(); ++i)
+
+    m_running = true;
+}//start
+
+//-------------------------
+
+/*!
+ * \brief DetectionPipeline::push Sends a frame to the pipeline. Waits while the pipeline is full.
+ * \param _image Frame image. Its data must not be modified until frame is popped: clone it if the caller reuses it.
+ * \param _id Caller defined identifier, given back with the result.
+ */
+void DetectionPipeline::push(const Mat & _image, qint64 _id)
+{
+    if (!m_running || m_finished)
+    {
+        deepDebug("DetectionPipeline::push : pipeline is not running.");
+        return;
+    }//if (!m_running || m_finished)
+
+    FramePtr pFrame(new Detector::Frame);
+    pFrame->id = _id;
+    pFrame->image = _image;
+
+    m_inputQueue.push(pFrame);
+}//push
+
+//-------------------------
+
+/*!
+ * \brief DetectionPipeline::finish Tells the pipeline that no more frame will be pushed. Remaining results can still be popped.
+ */
+void DetectionPipeline::finish()
+{
+    if (!m_running || m_finished) return;
+
+    m_inputQueue.push(FramePtr());
+    m_finished = true;
+}//finish
+
+//-------------------------
+
+/*!
+ * \brief DetectionPipeline::pop Returns next result, in push order. Waits until it is available.
+ *        Frame "result" and "subtitles" hold what "detect" would have returned.
+ * \return false once every result has been popped after "finish".
+ */
+bool DetectionPipeline::pop(FramePtr & _pFrame)
+{
+    if (!m_running || m_ended) return false;
+
+    m_outputQueue.pop(_pFrame);
+
+    if (!_pFrame) m_ended = true;
+
+    return !m_ended;
+}//pop
+
+//-------------------------
+
+/*!
+ * \brief DetectionPipeline::tryPop Same as "pop" without waiting.
+ * \param _ended Set to true once every result has been popped after "finish".
+ * \return true if a result has been popped.
+ */
+bool DetectionPipeline::tryPop(FramePtr & _pFrame, bool & _ended)
+{
+    _ended = m_ended;
+
+    if (!m_running || m_ended || !m_outputQueue.tryPop(_pFrame)) return false;
+
+    if (!_pFrame) m_ended = _ended = true;
+
+    return !m_ended;
+}//tryPop
+
+//-------------------------
+
+/*!
+ * \brief DetectionPipeline::stop Finishes the stream, drops remaining results and waits for stage threads.
+ */
+void DetectionPipeline::stop()
+{
+    if (!m_running) return;
+
+    finish();
+
+    FramePtr pFrame;
+    while (pop(pFrame)) {}
+
+    for (int i = 0; i < m_stages.size(); ++i)
+    {
+        m_stages[i]->wait();
+    }//for (int i = 0; i < m_stages.size(); ++i)
+
+    qDeleteAll(m_stages);
+    m_stages.clear();
+
+    m_running = false;
+}//stop
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,107 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_DETECTIONPIPELINE_H
+#define SUBDETECTION_DETECTIONPIPELINE_H
+
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+#include "subdetection_global.h"
+
+#include "detector.h"
+#include "spscqueue.h"
+
+namespace SubDetection
+{
+
+class DetectionStage;
+
+/*!
+ * \brief The DetectionPipeline class. Runs Detector steps on successive frames, each step in its own thread:
+ *        masking and change detection, then text line search, then recognition. Frame N + 1 is masked while
+ *        frame N is being recognized. Results are the same as calling Detector::detect on each frame, in order.
+ *
+ *        Stages are connected by bounded single producer, single consumer queues: "push" waits when the pipeline
+ *        is full. One thread pushes frames, one thread pops results (they may be the same one, alternating).
+ */
+class SUBDETECTIONSHARED_EXPORT DetectionPipeline
+{
+public:
+    typedef QSharedPointer<Detector::Frame> FramePtr;
+
+    static const int DEFAULT_QUEUE_CAPACITY = 4;
+
+    DetectionPipeline(const QSharedPointer<Parameters> & _pParams, const QString & _tessdataParentPath, const QString & _lang,
+                      int _queueCapacity = DEFAULT_QUEUE_CAPACITY);
+    ~DetectionPipeline();
+
+    //Settings. Ignored once started.
+    void setMaskingMethod(Detector::MaskingMethod _method);
+    void setChangeDetectionMethod(Detector::ChangeDetectionMethod _method);
+    void setExtractionMethod(ContourManager::ExtractionMethod _method);
+    void setContourInput(ContourManager::InputFormat _format);
+    void setLineFindingMethod(Detector::LineFindingMethod _method);
+    void enableZoneProcessing(bool _enabled);
+    void enableIncrementalRecognition(bool _enabled);
+    void enableIncrementalExtraction(bool _enabled);
+    void enableParallelRecognition(bool _enabled, int _maxThreads = 0);
+    void enableTiledProcessing(bool _enabled, int _maxThreads = 0);
+    void setOcrCache(const QSharedPointer<OcrCache> & _pCache);
+    void setOcrEnginePool(const Detector::OcrEnginePoolPtr & _pPool);
+
+    void start();
+    bool isRunning() const {return m_running;}
+
+    void push(const Mat & _image, qint64 _id);
+    void finish();
+
+    bool pop(FramePtr & _pFrame);
+    bool tryPop(FramePtr & _pFrame, bool & _ended);
+
+protected:
+    typedef SpscQueue<FramePtr> FrameQueue;
+
+    bool canChangeSettings(const char * _setter) const;
+    void stop();
+
+    Detector m_detector;///< Shared by all stages.
+    DetectionContext m_maskContext;
+    DetectionContext m_lineContext;
+    DetectionContext m_recognitionContext;
+
+    FrameQueue m_inputQueue;
+    FrameQueue m_maskedQueue;
+    FrameQueue m_linedQueue;
+    FrameQueue m_outputQueue;
+
+    QList<DetectionStage *> m_stages;
+
+    bool m_running;
+    bool m_finished;///< End of stream has been pushed.
+    bool m_ended;///< End of stream has been popped.
+
+private:
+    Q_DISABLE_COPY(DetectionPipeline)
+};//DetectionPipeline
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_DETECTIONPIPELINE_H
@@ -25,10 +25,10 @@
 
 #define SD_TEST_CENTERED 0
 
-#include <QMap>
-#include <QHash>
 #include <QImage>
 #include <QStringList>
+#include <QThread>
+#include <QtConcurrentRun>
 
 #include <opencv2/imgproc/imgproc.hpp>
 #if SD_TEST_DRAW
@@ -36,12 +36,13 @@
 #endif//SD_TEST_DRAW
 
 #include <algorithm>
+#include <cmath>
 
 #include "deepdebug.h"
 #include "blob.h"
 #include "hsvblob.h"
+#include "textlinegrouper.h"
 
-#include "hash.h"
 #include "types.h"
 
 #include "detector.h"
@@ -55,11 +56,6 @@ namespace
     {
         if (_value < 0) _value *= -1;
     }//abs
-//------
-    bool pointCompareAlongXAxis(const Point & _first, const Point & _second)
-    {
-        return ((_first.x < _second.x) || ((_first.x == _second.x) && (_first.y < _second.y)));
-    }//bool pointCompareAlongXAxis(const Point & _first, const Point & _second)
 //------
     bool rectCompareAlongYAxis(const Rect & _first, const Rect & _second)
     {
@@ -76,10 +72,6 @@ namespace
         return std::max(_first,_second);
     }//min
 //------
-    Point::value_type UNDEFINED_COORD = -1;
-
-    typedef QMap<Point::value_type,quint32> CoordCountMap;
-    typedef QHash<Point,Rect> BoundingRectHash;
     typedef QList<ContourVector::size_type> ContourIndexList;
 //------
 
@@ -105,14 +97,28 @@ namespace
     const char * DEFAULT_LANGUAGE = "eng";
 
     Detector::BlobSelectionBehavior DEFAULT_BSBEHAVIOR = Detector::BSB_INNER;
+
+    const int MIN_TILE_ROWS = 64;///< Minimum height of a band masked by one thread.
 //        Detector::BlobSelectionBehavior DEFAULT_BSBEHAVIOR = Detector::BSB_OUTTER;
 }//namespace
 
 Detector::Detector():
     m_pParams(0),
     m_drawBoundings(false),
-    m_ocr(DEFAULT_TESSERACT_PARENT_PATH, DEFAULT_LANGUAGE),
-    m_bsbehavior(DEFAULT_BSBEHAVIOR)
+    m_zoneProcessing(false),
+    m_incrementalRecognition(true),
+    m_incrementalExtraction(false),
+    m_pOcrPool(OcrEnginePool::shared(DEFAULT_TESSERACT_PARENT_PATH, DEFAULT_LANGUAGE)),
+    m_recognitionThreads(1),
+    m_tileThreads(1),
+    m_settingsVersion(0),
+    m_bsbehavior(DEFAULT_BSBEHAVIOR),
+    m_maskingMethod(MM_CONVERSION),
+    m_changeDetectionMethod(CDM_NORM),
+    m_extractionMethod(ContourManager::EM_CONTOURS),
+    m_contourInput(ContourManager::IF_COLOR),
+    m_lineGroupingMethod(TextLineGrouper::GM_SORTED),
+    m_lineFindingMethod(LFM_CONTOURS)
 {
     createParameters();
     forget();
@@ -122,8 +128,20 @@ Detector::Detector():
 
 Detector::Detector(const QSharedPointer<Parameters> & _pParams):
     m_drawBoundings(false),
-    m_ocr(DEFAULT_TESSERACT_PARENT_PATH, DEFAULT_LANGUAGE),
-    m_bsbehavior(DEFAULT_BSBEHAVIOR)
+    m_zoneProcessing(false),
+    m_incrementalRecognition(true),
+    m_incrementalExtraction(false),
+    m_pOcrPool(OcrEnginePool::shared(DEFAULT_TESSERACT_PARENT_PATH, DEFAULT_LANGUAGE)),
+    m_recognitionThreads(1),
+    m_tileThreads(1),
+    m_settingsVersion(0),
+    m_bsbehavior(DEFAULT_BSBEHAVIOR),
+    m_maskingMethod(MM_CONVERSION),
+    m_changeDetectionMethod(CDM_NORM),
+    m_extractionMethod(ContourManager::EM_CONTOURS),
+    m_contourInput(ContourManager::IF_COLOR),
+    m_lineGroupingMethod(TextLineGrouper::GM_SORTED),
+    m_lineFindingMethod(LFM_CONTOURS)
 {
     setParameters(_pParams);
 }//Detector Parameters *
@@ -132,8 +150,20 @@ Detector::Detector(const QSharedPointer<Parameters> & _pParams):
 
 Detector::Detector(const Parameters & _params):
     m_drawBoundings(false),
-    m_ocr(DEFAULT_TESSERACT_PARENT_PATH, DEFAULT_LANGUAGE),
-    m_bsbehavior(DEFAULT_BSBEHAVIOR)
+    m_zoneProcessing(false),
+    m_incrementalRecognition(true),
+    m_incrementalExtraction(false),
+    m_pOcrPool(OcrEnginePool::shared(DEFAULT_TESSERACT_PARENT_PATH, DEFAULT_LANGUAGE)),
+    m_recognitionThreads(1),
+    m_tileThreads(1),
+    m_settingsVersion(0),
+    m_bsbehavior(DEFAULT_BSBEHAVIOR),
+    m_maskingMethod(MM_CONVERSION),
+    m_changeDetectionMethod(CDM_NORM),
+    m_extractionMethod(ContourManager::EM_CONTOURS),
+    m_contourInput(ContourManager::IF_COLOR),
+    m_lineGroupingMethod(TextLineGrouper::GM_SORTED),
+    m_lineFindingMethod(LFM_CONTOURS)
 {
     setParameters(_params);
 }//Detector const Parameters &
@@ -148,8 +178,20 @@ Detector::Detector(const Parameters & _params):
  */
 Detector::Detector(const QSharedPointer<Parameters> & _pParams, const QString & _tessdataParentPath, const QString & _lang):
     m_drawBoundings(false),
-    m_ocr(_tessdataParentPath,_lang),
-    m_bsbehavior(DEFAULT_BSBEHAVIOR)
+    m_zoneProcessing(false),
+    m_incrementalRecognition(true),
+    m_incrementalExtraction(false),
+    m_pOcrPool(OcrEnginePool::shared(_tessdataParentPath,_lang)),
+    m_recognitionThreads(1),
+    m_tileThreads(1),
+    m_settingsVersion(0),
+    m_bsbehavior(DEFAULT_BSBEHAVIOR),
+    m_maskingMethod(MM_CONVERSION),
+    m_changeDetectionMethod(CDM_NORM),
+    m_extractionMethod(ContourManager::EM_CONTOURS),
+    m_contourInput(ContourManager::IF_COLOR),
+    m_lineGroupingMethod(TextLineGrouper::GM_SORTED),
+    m_lineFindingMethod(LFM_CONTOURS)
 {
     setParameters(_pParams);
 }//Detector Parameters *, const QString &, const QString &
@@ -163,8 +205,20 @@ Detector::Detector(const QSharedPointer<Parameters> & _pParams, const QString &
  */
 Detector::Detector(const QString & _tessdataParentPath, const QString & _lang):
     m_drawBoundings(false),
-    m_ocr(_tessdataParentPath,_lang),
-    m_bsbehavior(DEFAULT_BSBEHAVIOR)
+    m_zoneProcessing(false),
+    m_incrementalRecognition(true),
+    m_incrementalExtraction(false),
+    m_pOcrPool(OcrEnginePool::shared(_tessdataParentPath,_lang)),
+    m_recognitionThreads(1),
+    m_tileThreads(1),
+    m_settingsVersion(0),
+    m_bsbehavior(DEFAULT_BSBEHAVIOR),
+    m_maskingMethod(MM_CONVERSION),
+    m_changeDetectionMethod(CDM_NORM),
+    m_extractionMethod(ContourManager::EM_CONTOURS),
+    m_contourInput(ContourManager::IF_COLOR),
+    m_lineGroupingMethod(TextLineGrouper::GM_SORTED),
+    m_lineFindingMethod(LFM_CONTOURS)
 {
 }//Detector const QString &, const QString &
 
@@ -182,7 +236,7 @@ void Detector::setParameters(const QSharedPointer<Parameters> & _pParams)
 {
     m_pParams = _pParams;
 
-    forget();
+    settingsChanged();
 }//setParameters
 
 //-------------------------
@@ -194,7 +248,7 @@ void Detector::setParameters(const Parameters & _params)
 
     *m_pParams = _params;
 
-    forget();
+    settingsChanged();
 }//setParameters
 
 //-------------------------
@@ -207,6 +261,72 @@ void Detector::setBlobSelectionBehavior(BlobSelectionBehavior _behavior)
 
 //-------------------------
 
+/*! Sets how the HSV range mask is computed. MM_LOOKUP_TABLE gives the same mask as MM_CONVERSION
+    without HSV conversion. Its table is rebuilt when HSV parameters change. With ContourManager::EM_RUNS,
+    it masks straight into runs. Previous detection is forgotten.*/
+void Detector::setMaskingMethod(MaskingMethod _method)
+{
+    m_maskingMethod = _method;
+
+    settingsChanged();
+}//setMaskingMethod
+
+//-------------------------
+
+/*! Sets how text zone changes are detected. With CDM_PACKED, Parameters matchRatio is compared to the ratio
+    of differing pixels in the text zone. Previous detection is forgotten.*/
+void Detector::setChangeDetectionMethod(ChangeDetectionMethod _method)
+{
+    m_changeDetectionMethod = _method;
+
+    settingsChanged();
+}//setChangeDetectionMethod
+
+//-------------------------
+
+/*! Sets how character shapes are extracted. With ContourManager::EM_COMPONENTS or ContourManager::EM_RUNS, components
+    are labeled directly on the HSV range mask, and no masked Mat is built. ContourManager::EM_RUNS with MM_LOOKUP_TABLE
+    masks straight into runs: no full mask is written, text zone changes are detected on runs and only text lines
+    are decoded for recognition, into a mask Mat zeroed once then cleared line by line. Previous detection is forgotten.*/
+void Detector::setExtractionMethod(ContourManager::ExtractionMethod _method)
+{
+    m_extractionMethod = _method;
+
+    settingsChanged();
+}//setExtractionMethod
+
+//-------------------------
+
+/*! Sets what contour search works on. ContourManager::IF_COLOR: masked color image, converted to gray then thresholded
+    with Parameters thresh. ContourManager::IF_BINARY: HSV range mask directly, without building the masked Mat.
+    Both give the same contours unless some colors in HSV range are darker than thresh.*/
+void Detector::setContourInput(ContourManager::InputFormat _format)
+{
+    m_contourInput = _format;
+}//setContourInput
+
+//-------------------------
+
+/*! Sets how character mass centers are grouped into lines. Both methods give the same lines,
+    TextLineGrouper::GM_LEGACY is kept for comparison.*/
+void Detector::setLineGroupingMethod(TextLineGrouper::Method _method)
+{
+    m_lineGroupingMethod = _method;
+}//setLineGroupingMethod
+
+//-------------------------
+
+/*! Sets how text lines are found. LFM_PROJECTION skips contour extraction on clean frames: lines are read from
+    the projection profiles of the text zone mask, unless they look ambiguous. Previous detection is forgotten.*/
+void Detector::setLineFindingMethod(LineFindingMethod _method)
+{
+    m_lineFindingMethod = _method;
+
+    settingsChanged();
+}//setLineFindingMethod
+
+//-------------------------
+
 /*!
  * \brief Detector::enableBoundingsDrawing Enable or disable text boundings drawing.
  * \param _enabled true: enable, false: disable.
@@ -218,6 +338,118 @@ void Detector::enableBoundingsDrawing(bool _enabled)
 
 //-------------------------
 
+/*!
+ * \brief Detector::enableZoneProcessing Enable or disable zone processing. When enabled, HSV conversion, masking
+ *        and contour search only work on Parameters zone instead of the whole image. Intermediate Mats are then zone sized.
+ * \param _enabled true: enable, false: disable (default).
+ */
+void Detector::enableZoneProcessing(bool _enabled)
+{
+    m_zoneProcessing = _enabled;
+}//enableZoneProcessing
+
+//-------------------------
+
+/*!
+ * \brief Detector::enableIncrementalRecognition Enable or disable incremental recognition. When enabled, a text line
+ *        whose pixels are exactly the same as a line recognized on last change reuses its text instead of being recognized again.
+ * \param _enabled true: enable (default), false: disable.
+ */
+void Detector::enableIncrementalRecognition(bool _enabled)
+{
+    m_incrementalRecognition = _enabled;
+
+    settingsChanged();
+}//enableIncrementalRecognition
+
+//-------------------------
+
+/*!
+ * \brief Detector::enableIncrementalExtraction Enable or disable incremental extraction. With ContourManager::EM_COMPONENTS,
+ *        the mask is compared with the one of last change by bands of rows: components are labeled again only around
+ *        changed bands, others are reused. Worth it when text changes partly, e.g. a line added under another one.
+ *        Does nothing with ContourManager::EM_RUNS: runs are always labeled as a whole.
+ * \param _enabled true: enable, false: disable (default).
+ */
+void Detector::enableIncrementalExtraction(bool _enabled)
+{
+    m_incrementalExtraction = _enabled;
+}//enableIncrementalExtraction
+
+//-------------------------
+
+/*!
+ * \brief Detector::setOcrCache Sets the cache searched before sending a text line to OCR. Lines are found by their
+ *        exact pixels and OCR engine pool model (tessdata path and language). A cache may be shared between several
+ *        Detector instances, even in different threads and with different models.
+ * \param _pCache Cache to use. Null pointer disables caching (default).
+ */
+void Detector::setOcrCache(const QSharedPointer<OcrCache> & _pCache)
+{
+    m_pOcrCache = _pCache;
+}//setOcrCache
+
+//-------------------------
+
+/*!
+ * \brief Detector::enableParallelRecognition Enable or disable parallel recognition. When enabled, text lines of
+ *        a frame are recognized concurrently, each by its own OCR engine. Output line order is kept.
+ *        Engines are taken from the OCR engine pool: its maximum size also limits concurrency.
+ * \param _enabled true: enable, false: disable (default).
+ * \param _maxThreads Maximum number of lines recognized at the same time. 0: ideal thread count.
+ */
+void Detector::enableParallelRecognition(bool _enabled, int _maxThreads)
+{
+    if (_maxThreads <= 0) _maxThreads = QThread::idealThreadCount();
+
+    m_recognitionThreads = _enabled ? qMax(_maxThreads,1) : 1;
+}//enableParallelRecognition
+
+//-------------------------
+
+/*!
+ * \brief Detector::enableTiledProcessing Enable or disable tiled processing. When enabled, HSV masking of a frame is split
+ *        into horizontal bands processed concurrently, as well as component labeling with ContourManager::EM_COMPONENTS.
+ *        Bands are at least 64 rows high. Results are the same as without tiling.
+ *        Does nothing with ContourManager::EM_RUNS and MM_LOOKUP_TABLE: masking into runs and run labeling are single pass.
+ *        With ContourManager::EM_RUNS and MM_CONVERSION, only masking is tiled.
+ * \param _enabled true: enable, false: disable (default).
+ * \param _maxThreads Maximum number of bands processed at the same time. 0: ideal thread count.
+ */
+void Detector::enableTiledProcessing(bool _enabled, int _maxThreads)
+{
+    if (_maxThreads <= 0) _maxThreads = QThread::idealThreadCount();
+
+    m_tileThreads = _enabled ? qMax(_maxThreads,1) : 1;
+}//enableTiledProcessing
+
+//-------------------------
+
+/*!
+ * \brief Detector::setOcrEnginePool Sets the pool OCR engines are taken from. By default, Detector uses the shared
+ *        pool matching its tessdata path and language (see OcrEnginePool::shared). Contexts forget recognized lines
+ *        if tessdata path or language differs from current pool's.
+ * \param _pPool Pool to use. Must not be null.
+ */
+void Detector::setOcrEnginePool(const OcrEnginePoolPtr & _pPool)
+{
+    if (_pPool.isNull())
+    {
+        deepDebug("Detector::setOcrEnginePool : null pool ignored.");
+        return;
+    }//if (_pPool.isNull())
+
+    //Lines recognized with another model must be recognized again
+    bool modelChanged = (_pPool->language() != m_pOcrPool->language()
+                      || _pPool->tessdataParentPath() != m_pOcrPool->tessdataParentPath());
+
+    m_pOcrPool = _pPool;
+
+    if (modelChanged) settingsChanged();
+}//setOcrEnginePool
+
+//-------------------------
+
 /*!
  * \brief Detector::forget : if "detect" was precedently called, "forget" allows to forget previous detection, in case
  *        text has not changed. When your Detector Parameters points directly to an outside structure,
@@ -226,11 +458,38 @@ void Detector::enableBoundingsDrawing(bool _enabled)
  */
 void Detector::forget()
 {
-    m_forget = true;
+    m_context.forget();
 }//forget
 
 //-------------------------
 
+/*!
+ * \brief Detector::settingsChanged Called when settings make previous detections meaningless: every context will
+ *        forget its history on next detection.
+ */
+void Detector::settingsChanged()
+{
+    ++m_settingsVersion;
+
+    forget();
+}//settingsChanged
+
+//-------------------------
+
+/*!
+ * \brief Detector::checkSettings Makes _context forget its history if it was built with previous settings.
+ */
+void Detector::checkSettings(DetectionContext & _context) const
+{
+    if (_context.m_settingsVersion != m_settingsVersion)
+    {
+        _context.forget();
+        _context.m_settingsVersion = m_settingsVersion;
+    }//if (_context.m_settingsVersion != m_settingsVersion)
+}//checkSettings
+
+//-------------------------
+
 /*!
  * \brief Detector::detect : tries to find subtitles in the _image according to previously set Parameters.
  *        If Detector finds out that text has not changed, subtitles won't be searched. Call "forget"
@@ -239,95 +498,573 @@ void Detector::forget()
  * \param _subtitles detected text. If text has not changed, or at least if Detector thinks so, _subtitles won't be modified.
  */
 Detector::ReturnCode Detector::detect(const Mat & _image, QStringList & _subtitles)
+{
+    return detect(_image,_subtitles,m_context);
+}//detect
+
+//-------------------------
+
+/*!
+ * \brief Detector::detect : same as "detect" above, working with _context instead of the internal context. Thread safe.
+ * \param _context Scratch buffers and history of the image stream _image belongs to.
+ */
+Detector::ReturnCode Detector::detect(const Mat & _image, QStringList & _subtitles, DetectionContext & _context) const
+{
+    checkSettings(_context);
+
+    ReturnCode result = setWorkMat(_image,_context);
+
+    if (result != RC_OK) return result;
+
+    return processWorkMat(_subtitles,_context);
+}//detect
+
+//-------------------------
+
+/*!
+ * \brief Detector::setWorkMat Checks text zone and _image, then selects the Mat detection works on.
+ */
+Detector::ReturnCode Detector::setWorkMat(const Mat & _image, DetectionContext & _context) const
+{
+    if (!zoneIsSet()) return RC_BAD_PARAM;
+
+    return selectWorkMat(_image,_context);
+}//setWorkMat
+
+//-------------------------
+
+/*!
+ * \brief Detector::zoneIsSet Returns false if Parameters text zone is empty.
+ */
+bool Detector::zoneIsSet() const
+{
+    if (!m_pParams->zone.width || !m_pParams->zone.height)
+    {
+        deepDebug("Detector::zoneIsSet : Invalid text zone. w:%d h:%d",m_pParams->zone.width,m_pParams->zone.height);
+
+        return false;
+    }//if (!m_pParams->zone.width || !m_pParams->zone.height)
+
+    return true;
+}//zoneIsSet
+
+//-------------------------
+
+/*!
+ * \brief Detector::selectWorkMat Same as "setWorkMat", text zone being known to be set: only checks _image and
+ *        whether the zone fits in it.
+ */
+Detector::ReturnCode Detector::selectWorkMat(const Mat & _image, DetectionContext & _context) const
 {
     deepDebug2("rows:%d, cols:%d",_image.rows,_image.cols);
 
-    if (!m_pParams->zone.width
-     || !m_pParams->zone.height
-     || (m_pParams->zone.x + m_pParams->zone.width > _image.cols)
+    if (!_image.rows || !_image.cols)
+    {
+        deepDebug("Detector::selectWorkMat : Invalid row or col number for input Mat.");
+
+        return RC_INVALID_INPUT_IMAGE;
+    }//if (!_image.rows || !_image.cols)
+
+    if ((m_pParams->zone.x + m_pParams->zone.width > _image.cols)
      || (m_pParams->zone.y + m_pParams->zone.height > _image.rows))
     {
-        deepDebug("Detector::detect : Invalid text zone. x:%d y:%d w:%d h:%d",
+        deepDebug("Detector::selectWorkMat : Text zone out of image. x:%d y:%d w:%d h:%d",
                   m_pParams->zone.x,
                   m_pParams->zone.y,
                   m_pParams->zone.width,
                   m_pParams->zone.height);
 
         return RC_BAD_PARAM;
-    }//if (!m_pParams->zone.width...
+    }//if ((m_pParams->zone.x + m_pParams->zone.width > _image.cols)...
 
-    if (!_image.rows || !_image.cols)
+//    m_centered = _centered;
+    _context.m_originalMat = _image;
+    _context.m_originalOffset = Point(0,0);
+
+    if (m_zoneProcessing)
+    {
+        //Only the text zone is processed. Coordinates are relative to it.
+        _context.m_workMat = _context.m_originalMat(m_pParams->zone);
+        _context.m_workZone = Rect(Point(0,0),m_pParams->zone.size());
+        _context.m_workOffset = m_pParams->zone.tl();
+    }//if (m_zoneProcessing)
+    else
     {
-        deepDebug("Detector::detect : Invalid row or col number for input Mat.");
+        _context.m_workMat = _context.m_originalMat;
+        _context.m_workZone = m_pParams->zone;
+        _context.m_workOffset = Point(0,0);
+    }//if (m_zoneProcessing)...else
+
+    return RC_OK;
+}//selectWorkMat
+
+//-------------------------
+
+/*!
+ * \brief Detector::detectZone : same as "detect" with zone processing, but _zoneImage only holds the text zone.
+ *        Avoids keeping whole images when only text zones are buffered. Bounding rects are still given in
+ *        original image coordinates, while boundings are drawn on the zone image, in zone coordinates.
+ * \param _zoneImage Text zone of an image. Its size must be Parameters zone size.
+ * \param _subtitles detected text. If text has not changed, or at least if Detector thinks so, _subtitles won't be modified.
+ */
+Detector::ReturnCode Detector::detectZone(const Mat & _zoneImage, QStringList & _subtitles)
+{
+    return detectZone(_zoneImage,_subtitles,m_context);
+}//detectZone
+
+//-------------------------
+
+/*!
+ * \brief Detector::detectZone : same as "detectZone" above, working with _context instead of the internal context. Thread safe.
+ */
+Detector::ReturnCode Detector::detectZone(const Mat & _zoneImage, QStringList & _subtitles, DetectionContext & _context) const
+{
+    checkSettings(_context);
+
+    if (!_zoneImage.rows || !_zoneImage.cols)
+    {
+        deepDebug("Detector::detectZone : Invalid row or col number for input Mat.");
 
         return RC_INVALID_INPUT_IMAGE;
-    }//if (!_image.rows || !_image.cols)
+    }//if (!_zoneImage.rows || !_zoneImage.cols)
 
-//    m_centered = _centered;
-    m_originalMat = _image;
+    if (_zoneImage.cols != m_pParams->zone.width || _zoneImage.rows != m_pParams->zone.height)
+    {
+        deepDebug("Detector::detectZone : zone image is %dx%d, text zone is %dx%d.",
+                  _zoneImage.cols,
+                  _zoneImage.rows,
+                  m_pParams->zone.width,
+                  m_pParams->zone.height);
+
+        return RC_BAD_PARAM;
+    }//if (_zoneImage.cols != m_pParams->zone.width...
+
+    _context.m_originalMat = _zoneImage;
+    _context.m_originalOffset = m_pParams->zone.tl();
+    _context.m_workMat = _zoneImage;
+    _context.m_workZone = Rect(Point(0,0),m_pParams->zone.size());
+    _context.m_workOffset = m_pParams->zone.tl();
+
+    return processWorkMat(_subtitles,_context);
+}//detectZone
+
+//-------------------------
+
+/*!
+ * \brief Detector::textZoneMask Computes the HSV range mask of a text zone, packed. Much cheaper than "detect":
+ *        no contour is searched, nothing is recognized and the saved text zone is left untouched.
+ * \param _zoneImage Text zone of an image.
+ * \param _bits Output mask.
+ */
+void Detector::textZoneMask(const Mat & _zoneImage, PackedMask & _bits) const
+{
+    if (masksToRuns(_zoneImage))
+    {
+        RleMask runs;
+        hsvMaskTable()->apply(_zoneImage,runs);
+
+        _bits.pack(runs,Rect(0,0,_zoneImage.cols,_zoneImage.rows));
+        return;
+    }//if (masksToRuns(_zoneImage))
+
+    Mat mask;
+    Mat hsvMat;
+    hsvMask(_zoneImage,mask,hsvMat);
+
+    _bits.pack(mask);
+}//textZoneMask
+
+//-------------------------
+
+/*!
+ * \brief Detector::textZonesMatch Compares two masks computed by "textZoneMask", the way "detect" compares
+ *        text zones with current change detection method.
+ * \return true if text zones are considered very similar.
+ */
+bool Detector::textZonesMatch(const PackedMask & _first, const PackedMask & _second) const
+{
+    if (m_changeDetectionMethod == CDM_PACKED) return compareMasks(_first,_second);
+
+    if (_first.isEmpty() || !_first.hasSameSize(_second)) return false;
+
+    //L2 norm between two 0/255 masks
+    double distance = 255. * std::sqrt(static_cast<double>(_first.differenceCount(_second)));
+
+    return (distance / static_cast<double>(_first.rows() * _first.cols()) < m_pParams->matchRatio);
+}//textZonesMatch
+
+//-------------------------
 
+/*!
+ * \brief Detector::processWorkMat Detection steps common to "detect" and "detectZone", once work Mat is set.
+ */
+Detector::ReturnCode Detector::processWorkMat(QStringList & _subtitles, DetectionContext & _context) const
+{
+    setupContourManager(_context);
+
+    return detectInWorkMat(_subtitles,_context);
+}//processWorkMat
+
+//-------------------------
+
+/*!
+ * \brief Detector::detectInWorkMat Same as "processWorkMat", _context contour manager being already set up.
+ *        Batches set up each thread context once, then call it for every image.
+ */
+Detector::ReturnCode Detector::detectInWorkMat(QStringList & _subtitles, DetectionContext & _context) const
+{
+    if (!maskWorkMat(_context)) return RC_NO_CHANGE;
+
+    findTextRects(_context);
+
+    recognizeLines(_subtitles,_context);
+
+    return RC_OK;
+}//detectInWorkMat
+
+//-------------------------
+
+/*!
+ * \brief Detector::maskWorkMat Computes HSV range mask of work Mat, then compares its text zone to the saved one.
+ * \return true if text zone has changed.
+ */
+bool Detector::maskWorkMat(DetectionContext & _context) const
+{
 //----HSV masking
-    cv::cvtColor(m_originalMat,m_hsvMat,cv::COLOR_BGR2HSV);//HSV conversion
+    if (masksToRuns(_context.m_workMat))
+    {
+        //No mask Mat: text zone is packed from runs, lines are decoded once found
+        hsvMaskTable()->apply(_context.m_workMat,_context.m_runMask);
+
+        _context.m_hsvMat.release();
+        _context.m_textZoneMat.release();
+        _context.m_textZoneBits.pack(_context.m_runMask,_context.m_workZone);
+    }//if (masksToRuns(_context.m_workMat))
+    else
+    {
+        _context.m_runMask.clear();
+        _context.m_linesDecoded = false;
 
-    //Changing desired colors into white
-    cv::inRange(m_hsvMat, m_pParams->hsvMin.toScalar(), m_pParams->hsvMax.toScalar(), m_threshMat);
+        hsvMask(_context.m_workMat,_context.m_threshMat,_context.m_hsvMat);
 
-    m_textZoneMat = m_threshMat(m_pParams->zone);
+        _context.m_textZoneMat = _context.m_threshMat(_context.m_workZone);
+    }//if (masksToRuns(_context.m_workMat))...else
 
     //Detecting if text has changed
-    if (!m_forget && compareImages(m_oldTextZoneMat,m_textZoneMat))
+    if (!textZoneChanged(_context))
     {
         deepDebug("Text has not changed!");
-        return RC_NO_CHANGE;
-    }//if (compareImages(m_oldTextZoneMat,m_textZoneMat))
+        return false;
+    }//if (!textZoneChanged(_context))
 
-    if (m_forget) m_forget = false;
+    return true;
+}//maskWorkMat
 
-    m_oldTextZoneMat = m_textZoneMat.clone();
+//-------------------------
+
+/*!
+ * \brief Detector::setupContourManager Applies current settings to _context contour manager.
+ */
+void Detector::setupContourManager(DetectionContext & _context) const
+{
+    _context.m_contourManager.setExtractionMethod(m_extractionMethod);
+    _context.m_contourManager.setNoiseLimits(m_pParams->charMinSize,m_pParams->charMinArea);
+    _context.m_contourManager.setMaxThreads(m_tileThreads);
+    _context.m_contourManager.enableIncrementalLabeling(m_incrementalExtraction);
+    _context.m_contourManager.setBinThresh(m_pParams->thresh);
+    _context.m_contourManager.setRetrievalMode(CV_RETR_EXTERNAL);
+    _context.m_contourManager.setApproxMethod(CV_CHAIN_APPROX_SIMPLE);
+}//setupContourManager
 
-    //Get only desired colors from the original image
-    m_maskedMat = Mat::zeros(m_originalMat.size(),m_originalMat.type());
-    cv::bitwise_and(m_originalMat,m_originalMat,m_maskedMat,m_threshMat);
+//-------------------------
+
+/*!
+ * \brief Detector::findTextRects Searches character contours in masked work Mat and groups them into text lines.
+ *        _context contour manager must have been set up.
+ */
+void Detector::findTextRects(DetectionContext & _context) const
+{
+    _context.m_filterStatistics = DetectionContext::FilterStatistics();
+
+    if (m_lineFindingMethod == LFM_PROJECTION && findProjectedTextRects(_context)) return;
+
+    if (!_context.m_runMask.isEmpty())
+    {
+        //Runs are labeled as they come from masking
+        _context.m_maskedMat.release();
+
+        _context.m_contourManager.process(_context.m_runMask,ContourManager::SFBoundings | ContourManager::SFMassCenters);
+    }//if (!_context.m_runMask.isEmpty())
+    else if (m_extractionMethod != ContourManager::EM_CONTOURS || m_contourInput == ContourManager::IF_BINARY)
+    {
+        //HSV range mask is searched directly
+        _context.m_maskedMat.release();
+
+        _context.m_contourManager.process(_context.m_threshMat,ContourManager::IF_BINARY,ContourManager::SFBoundings | ContourManager::SFMassCenters);
+    }//if (!_context.m_runMask.isEmpty())...else if (m_extractionMethod != ContourManager::EM_CONTOURS...
+    else
+    {
+        //Get only desired colors from the original image
+        //Buffer is reused when size and type match previous frame
+        _context.m_maskedMat.create(_context.m_workMat.size(),_context.m_workMat.type());
+        _context.m_maskedMat.setTo(Scalar::all(0));
+        cv::bitwise_and(_context.m_workMat,_context.m_workMat,_context.m_maskedMat,_context.m_threshMat);
 
 #if SD_MASKED_TYPES
-    //Grayscale before edge detection
-    switch (m_maskedMat.type())
-    {
-    case CV_8UC4:
-        deepDebug("Masked type: CV_8UC4");
-        break;
-    case CV_8UC1:
-        deepDebug("Masked type: CV_8UC1");
-        break;
-    default:
-        deepDebug("Masked type: other");
-        break;
-    }//switch (m_maskedMat.type())
+        //Grayscale before edge detection
+        switch (_context.m_maskedMat.type())
+        {
+        case CV_8UC4:
+            deepDebug("Masked type: CV_8UC4");
+            break;
+        case CV_8UC1:
+            deepDebug("Masked type: CV_8UC1");
+            break;
+        default:
+            deepDebug("Masked type: other");
+            break;
+        }//switch (_context.m_maskedMat.type())
 #endif//SD_MASKED_TYPES
 
-    ContourVector contours;
+        _context.m_contourManager.process(_context.m_maskedMat,ContourManager::SFBoundings | ContourManager::SFMassCenters);
+    }//if (!_context.m_runMask.isEmpty())...else
 
-    m_contourManager.setBinThresh(m_pParams->thresh);
-    m_contourManager.setRetrievalMode(CV_RETR_EXTERNAL);
-    m_contourManager.setApproxMethod(CV_CHAIN_APPROX_SIMPLE);
+    _context.m_boundingRects.clear();
+    getTextBoundingRects(_context.m_boundingRects,_context);
 
-    m_contourManager.process(m_maskedMat,ContourManager::SFBoundings | ContourManager::SFMassCenters);
+    if (!_context.m_runMask.isEmpty()) decodeTextLines(_context);
+}//findTextRects
 
-    m_contourManager.contours(contours);
+//-------------------------
 
-    m_boundingRects.clear();
-    getTextBoundingRects(contours,m_boundingRects);
+/*!
+ * \brief Detector::findProjectedTextRects Searches text lines in the projection profiles of the text zone mask.
+ * \return false if lines are ambiguous. Contour path must be used then.
+ */
+bool Detector::findProjectedTextRects(DetectionContext & _context) const
+{
+    _context.m_lineFinder.setCharMaxSize(m_pParams->charMaxSize);
+    _context.m_lineFinder.setNoiseLimits(m_pParams->charMinSize,m_pParams->charMinArea);
+    _context.m_lineFinder.setTolerances(m_pParams->xTolerance,m_pParams->yTolerance);
 
-    m_ocr.setImage(m_threshMat);
+    if (!_context.m_lineFinder.find(_context.m_threshMat(_context.m_workZone),_context.m_boundingRects))
+    {
+        deepDebug2("Detector::findProjectedTextRects : ambiguous lines, using contours.");
+        return false;
+    }//if (!_context.m_lineFinder.find(_context.m_threshMat(_context.m_workZone),_context.m_boundingRects))
 
-    for (RectVector::size_type i = 0; i < m_boundingRects.size(); ++i)
+    //Zone coordinates to work Mat coordinates
+    for (RectVector::size_type i = 0; i < _context.m_boundingRects.size(); ++i)
     {
-        m_ocr.setRectangle(m_boundingRects[i]);
-        _subtitles.push_back(m_ocr.getUtf8Text());
-    }//for (RectVector::size_type i = 0; i < m_boundingRects.size(); ++i)
+        _context.m_boundingRects[i] += _context.m_workZone.tl();
+    }//for (RectVector::size_type i = 0; i < _context.m_boundingRects.size(); ++i)
 
-    return RC_OK;
-}//detect
+    _context.m_maskedMat.release();
+    _context.m_boundingsMat = _context.m_originalMat;
+
+    return true;
+}//findProjectedTextRects
+
+//-------------------------
+
+/*!
+ * \brief Detector::decodeTextLines When masked straight into runs, writes text lines into the mask Mat recognition
+ *        works on. Other pixels are left null: the rest of the mask is never decoded. The Mat is zeroed only when
+ *        it is (re)allocated; otherwise only the lines decoded last time are cleared.
+ */
+void Detector::decodeTextLines(DetectionContext & _context) const
+{
+    if (_context.m_linesDecoded
+     && _context.m_threshMat.rows == _context.m_runMask.rows()
+     && _context.m_threshMat.cols == _context.m_runMask.cols()
+     && _context.m_threshMat.type() == CV_8UC1)
+    {
+        for (RectVector::size_type i = 0; i < _context.m_decodedLineRects.size(); ++i)
+        {
+            _context.m_threshMat(_context.m_decodedLineRects[i]).setTo(Scalar::all(0));
+        }//for (RectVector::size_type i = 0; i < _context.m_decodedLineRects.size(); ++i)
+    }//if (_context.m_linesDecoded...
+    else
+    {
+        _context.m_threshMat.create(_context.m_runMask.rows(),_context.m_runMask.cols(),CV_8UC1);
+        _context.m_threshMat.setTo(Scalar::all(0));
+    }//if (_context.m_linesDecoded...else
+
+    for (RectVector::size_type i = 0; i < _context.m_boundingRects.size(); ++i)
+    {
+        _context.m_runMask.decode(_context.m_threshMat,_context.m_boundingRects[i]);
+    }//for (RectVector::size_type i = 0; i < _context.m_boundingRects.size(); ++i)
+
+    _context.m_decodedLineRects = _context.m_boundingRects;
+    _context.m_linesDecoded = true;
+}//decodeTextLines
+
+//-------------------------
+
+/*!
+ * \brief Detector::masksToRuns Returns true if _image is masked straight into runs: MM_LOOKUP_TABLE and
+ *        ContourManager::EM_RUNS on a supported image. LFM_PROJECTION needs the mask Mat, so it disables it.
+ */
+bool Detector::masksToRuns(const Mat & _image) const
+{
+    return (m_maskingMethod == MM_LOOKUP_TABLE
+         && m_extractionMethod == ContourManager::EM_RUNS
+         && m_lineFindingMethod == LFM_CONTOURS
+         && HsvMaskTable::isSupported(_image));
+}//masksToRuns
+
+//-------------------------
+
+/*!
+ * \brief Detector::detectBatch Detects text in independent images, spread over several threads.
+ *        Each image is processed as if "forget" had been called before: no change detection between images.
+ *        Text zone is validated once for the whole batch and each thread sets up its context once: only zone bounds
+ *        are checked against each image. Context buffers are reused from one image to the next.
+ * \param _images Input images.
+ * \param _results Output results, in the same order as _images. Same as "detect" for each image.
+ * \param _maxThreads Maximum number of images processed at the same time. 0: ideal thread count.
+ */
+void Detector::detectBatch(const std::vector<Mat> & _images, ResultVector & _results, int _maxThreads) const
+{
+    _results.assign(_images.size(),Result());
+
+    if (_images.empty()) return;
+
+    if (!zoneIsSet())
+    {
+        for (ResultVector::size_type i = 0; i < _results.size(); ++i)
+        {
+            _results[i].result = RC_BAD_PARAM;
+        }//for (ResultVector::size_type i = 0; i < _results.size(); ++i)
+
+        return;
+    }//if (!zoneIsSet())
+
+    if (_maxThreads <= 0) _maxThreads = QThread::idealThreadCount();
+
+    int threadCount = qMin(qMax(_maxThreads,1),static_cast<int>(_images.size()));
+
+    QAtomicInt nextFrame(0);
+
+    BatchTask task;
+    task.pDetector = this;
+    task.pImages = &_images;
+    task.pResults = &_results;
+    task.pNextFrame = &nextFrame;
+
+    QList<QFuture<void> > futures;
+
+    //Current thread takes part too
+    for (int i = 1; i < threadCount; ++i)
+    {
+        futures.append(QtConcurrent::run(&Detector::runBatchTask,task));
+    }//for (int i = 1; i < threadCount; ++i)
+
+    runBatchTask(task);
+
+    for (int i = 0; i < futures.size(); ++i)
+    {
+        futures[i].waitForFinished();
+    }//for (int i = 0; i < futures.size(); ++i)
+}//detectBatch
+
+//-------------------------
+
+/*!
+ * \brief Detector::runBatchTask Detects text in batch images until none is left, with a context of its own.
+ */
+void Detector::runBatchTask(const BatchTask & _task)
+{
+    const Detector & detector = *_task.pDetector;
+
+    //Settings do not change during a batch
+    DetectionContext context;
+    detector.setupContourManager(context);
+
+    int frameCount = static_cast<int>(_task.pImages->size());
+    int frame = _task.pNextFrame->fetchAndAddOrdered(1);
+
+    while (frame < frameCount)
+    {
+        Result & result = (*_task.pResults)[frame];
+
+        //Images are independent
+        context.forget();
+
+        result.result = detector.selectWorkMat((*_task.pImages)[frame],context);
+
+        if (result.result == RC_OK) result.result = detector.detectInWorkMat(result.subtitles,context);
+
+        if (result.result == RC_OK) context.textBoundingRects(result.boundingRects);
+
+        frame = _task.pNextFrame->fetchAndAddOrdered(1);
+    }//while (frame < frameCount)
+}//runBatchTask
+
+//-------------------------
+
+/*!
+ * \brief Detector::maskStage First pipeline stage: checks frame image, masks it and detects text changes.
+ *        Frame result is RC_OK if text zone has changed. Mask is handed over to the frame.
+ */
+void Detector::maskStage(Frame & _frame, DetectionContext & _context) const
+{
+    checkSettings(_context);
+
+    _frame.result = setWorkMat(_frame.image,_context);
+
+    if (_frame.result != RC_OK) return;
+
+    if (!maskWorkMat(_context)) _frame.result = RC_NO_CHANGE;
+
+    //Next frame must not overwrite this one's mask
+    _frame.threshMat = _context.m_threshMat;
+    _context.m_threshMat = Mat();
+    _context.m_linesDecoded = false;
+    _frame.runMask.swap(_context.m_runMask);
+}//maskStage
+
+//-------------------------
+
+/*!
+ * \brief Detector::lineStage Second pipeline stage: finds text line rects of a changed frame.
+ */
+void Detector::lineStage(Frame & _frame, DetectionContext & _context) const
+{
+    if (_frame.result != RC_OK) return;
+
+    setWorkMat(_frame.image,_context);
+    _context.m_threshMat = _frame.threshMat;
+    _context.m_linesDecoded = false;
+    _context.m_runMask.swap(_frame.runMask);
+
+    setupContourManager(_context);
+    findTextRects(_context);
+
+    _frame.boundingRects = _context.m_boundingRects;
+
+    //Text lines may have been decoded into a new mask. Recognition stage reads it while next frame is processed.
+    _frame.threshMat = _context.m_threshMat;
+    _context.m_threshMat = Mat();
+    _context.m_linesDecoded = false;
+}//lineStage
+
+//-------------------------
+
+/*!
+ * \brief Detector::recognitionStage Last pipeline stage: recognizes text lines of a changed frame.
+ */
+void Detector::recognitionStage(Frame & _frame, DetectionContext & _context) const
+{
+    checkSettings(_context);
+
+    if (_frame.result != RC_OK) return;
+
+    _context.m_threshMat = _frame.threshMat;
+    _context.m_boundingRects = _frame.boundingRects;
+
+    recognizeLines(_frame.subtitles,_context);
+}//recognitionStage
 
 //-------------------------
 
@@ -351,14 +1088,24 @@ Detector::ReturnCode Detector::getPointedBlob(const Mat & _image, const Point &
     if (result != RC_OK) return result;
 
     //Retrieving contours
-    ContourManager::Attributes cmAttributes;
-    blobContourSetup(cmAttributes);
+    blobContourSetup();
 
-    return getPointedBlob(cmAttributes,_point,_pBlob);
+    return getPointedBlob(m_context.m_contourManager,_point,_pBlob);
 }//getPointedBlob
 
 //-------------------------
 
+/*!
+ * \brief Detector::textBoundingRects After a call to "detect", populates _rects with the text line rects, in original Mat coordinates.
+ * \param _rects Output rect list.
+ */
+void Detector::textBoundingRects(RectVector & _rects) const
+{
+    m_context.textBoundingRects(_rects);
+}//textBoundingRects
+
+//-------------------------
+
 /*!
  * \brief Detector::createParameters Create new parameters, releasing previous ones.
  */
@@ -388,6 +1135,129 @@ Detector::ReturnCode Detector::checkImage(const Mat & _image) const
 
 //------------------------------
 
+/*!
+ * \brief Detector::hsvMaskTable Returns the lookup table for current HSV range, built on first call after a range change.
+ *        Callers keep using the table they got even if another thread replaces it.
+ */
+QSharedPointer<const HsvMaskTable> Detector::hsvMaskTable() const
+{
+    QMutexLocker locker(&m_hsvMaskTableMutex);
+
+    if (!m_pHsvMaskTable
+     || m_pHsvMaskTable->hsvMin() != m_pParams->hsvMin
+     || m_pHsvMaskTable->hsvMax() != m_pParams->hsvMax)
+    {
+        QSharedPointer<HsvMaskTable> pTable(new HsvMaskTable);
+        pTable->setRange(m_pParams->hsvMin,m_pParams->hsvMax);
+
+        m_pHsvMaskTable = pTable;
+    }//if (!m_pHsvMaskTable...
+
+    return m_pHsvMaskTable;
+}//hsvMaskTable
+
+//------------------------------
+
+/*!
+ * \brief Detector::hsvMask Changes colors in HSV parameter range into white, others into black.
+ *        With tiled processing, horizontal bands of _image are masked concurrently.
+ * \param _image Input BGR image.
+ * \param _mask Output mask.
+ * \param _hsvMat Output HSV image. Released with MM_LOOKUP_TABLE.
+ */
+void Detector::hsvMask(const Mat & _image, Mat & _mask, Mat & _hsvMat) const
+{
+    QSharedPointer<const HsvMaskTable> pTable;
+
+    if (m_maskingMethod == MM_LOOKUP_TABLE && HsvMaskTable::isSupported(_image)) pTable = hsvMaskTable();
+
+    int bandCount = max(1,min(m_tileThreads,_image.rows / MIN_TILE_ROWS));
+
+    if (bandCount == 1)
+    {
+        hsvMaskBand(_image,_mask,_hsvMat,pTable.data());
+    }//if (bandCount == 1)
+    else
+    {
+        //Bands write into whole Mats allocated once
+        _mask.create(_image.rows,_image.cols,CV_8UC1);
+
+        if (!pTable) _hsvMat.create(_image.rows,_image.cols,CV_8UC3);
+
+        std::vector<MaskTask> tasks(bandCount);
+
+        for (int i = 0; i < bandCount; ++i)
+        {
+            int firstRow = i * _image.rows / bandCount;
+            int lastRow = (i + 1) * _image.rows / bandCount;
+
+            MaskTask & task = tasks[i];
+            task.pDetector = this;
+            task.image = _image.rowRange(firstRow,lastRow);
+            task.mask = _mask.rowRange(firstRow,lastRow);
+            if (!pTable) task.hsvMat = _hsvMat.rowRange(firstRow,lastRow);
+            task.pTable = pTable.data();
+        }//for (int i = 0; i < bandCount; ++i)
+
+        QList<QFuture<void> > futures;
+
+        //Current thread takes first band
+        for (int i = 1; i < bandCount; ++i)
+        {
+            futures.append(QtConcurrent::run(&Detector::runMaskTask,tasks[i]));
+        }//for (int i = 1; i < bandCount; ++i)
+
+        runMaskTask(tasks[0]);
+
+        for (int i = 0; i < futures.size(); ++i)
+        {
+            futures[i].waitForFinished();
+        }//for (int i = 0; i < futures.size(); ++i)
+    }//if (bandCount == 1)...else
+
+    if (pTable) _hsvMat.release();
+}//hsvMask
+
+//------------------------------
+
+/*!
+ * \brief Detector::hsvMaskBand Computes the HSV range mask of _image, or of a band of it.
+ * \param _image Input BGR image.
+ * \param _mask Output mask. Written in place when already allocated with the right size and type.
+ * \param _hsvMat Output HSV image. Untouched when _pTable is set.
+ * \param _pTable Lookup table to use. Null: HSV conversion then range check.
+ */
+void Detector::hsvMaskBand(const Mat & _image, Mat & _mask, Mat & _hsvMat, const HsvMaskTable * _pTable) const
+{
+    if (_pTable)
+    {
+        _pTable->apply(_image,_mask);
+    }//if (_pTable)
+    else
+    {
+        cv::cvtColor(_image,_hsvMat,cv::COLOR_BGR2HSV);//HSV conversion
+
+        //Changing desired colors into white
+        cv::inRange(_hsvMat, m_pParams->hsvMin.toScalar(), m_pParams->hsvMax.toScalar(), _mask);
+    }//if (_pTable)...else
+}//hsvMaskBand
+
+//------------------------------
+
+/*!
+ * \brief Detector::runMaskTask Masks one band of a tiled image.
+ */
+void Detector::runMaskTask(const MaskTask & _task)
+{
+    //Headers share the data of the whole Mats
+    Mat mask = _task.mask;
+    Mat hsvMat = _task.hsvMat;
+
+    _task.pDetector->hsvMaskBand(_task.image,mask,hsvMat,_task.pTable);
+}//runMaskTask
+
+//------------------------------
+
 /*!
  * \brief Detector::compareImages : check whether images are similar.
  * \param _first first image.
@@ -421,279 +1291,189 @@ bool Detector::compareImages(const Mat & _first, const Mat & _second) const
 //------------------------------
 
 /*!
- * \brief getTextBoundingRects Compute bounding rects of the given contours. Each rect contains a maximum of aligned contours.
- * \param _contours
- * \param _rects The computed rects.
+ * \brief Detector::compareMasks : check whether packed masks are similar.
+ * \param _first first mask.
+ * \param _second second mask.
+ * \return true if the ratio of differing pixels is under Parameters matchRatio.
+ */
+bool Detector::compareMasks(const PackedMask & _first, const PackedMask & _second) const
+{
+    bool result = false;
+
+    if (_first.isEmpty() || !_first.hasSameSize(_second))
+    {
+        deepDebug("Detector::compareMasks : masks are different.");
+    }//if (_first.isEmpty() || !_first.hasSameSize(_second))
+    else
+    {
+        double matchValue = _first.differenceRatio(_second);
+
+        deepDebug2("Match value: %lf",matchValue);
+
+        result = (matchValue < m_pParams->matchRatio);
+    }//if (_first.isEmpty() || !_first.hasSameSize(_second))...else
+
+    return result;
+}//compareMasks
+
+//------------------------------
+
+/*!
+ * \brief Detector::textZoneChanged Compares current text zone to the one saved on last change, according to
+ *        change detection method. If text zone has changed, or previous detection was forgotten, it is saved.
+ * \return true if text zone has changed.
  */
-void Detector::getTextBoundingRects(const ContourVector &_contours, RectVector & _rects)
+bool Detector::textZoneChanged(DetectionContext & _context) const
 {
-    ContourVector::size_type contourSize = _contours.size();
+    if (!_context.m_runMask.isEmpty())
+    {
+        //Text zone already packed from runs. Both methods give the same result on packed masks.
+        if (!_context.m_forget && textZonesMatch(_context.m_oldTextZoneBits,_context.m_textZoneBits)) return false;
+
+        _context.m_oldTextZoneBits.swap(_context.m_textZoneBits);
+    }//if (!_context.m_runMask.isEmpty())
+    else if (m_changeDetectionMethod == CDM_PACKED)
+    {
+        _context.m_textZoneBits.pack(_context.m_textZoneMat);
+
+        if (!_context.m_forget && compareMasks(_context.m_oldTextZoneBits,_context.m_textZoneBits)) return false;
 
-    PointVector massCenters;
-    m_contourManager.massCenters(massCenters);
+        _context.m_oldTextZoneBits.swap(_context.m_textZoneBits);
+    }//if (!_context.m_runMask.isEmpty())...else if (m_changeDetectionMethod == CDM_PACKED)
+    else
+    {
+        if (!_context.m_forget && compareImages(_context.m_oldTextZoneMat,_context.m_textZoneMat)) return false;
+
+        _context.m_oldTextZoneMat = _context.m_textZoneMat.clone();
+        _context.m_oldTextZoneBits.pack(_context.m_oldTextZoneMat);//Reference only, packed once per change
+    }//if (!_context.m_runMask.isEmpty())...else
+
+    _context.m_forget = false;
 
-    RectVector boundingRects;
-    m_contourManager.boundingRects(boundingRects);
+    return true;
+}//textZoneChanged
 
+//------------------------------
+
+/*!
+ * \brief getTextBoundingRects Compute bounding rects of the shapes found by the context contour manager.
+ *        Each rect contains a maximum of aligned shapes.
+ * \param _rects The computed rects.
+ */
+void Detector::getTextBoundingRects(RectVector & _rects, DetectionContext & _context) const
+{
+    ComponentTable components;
+    _context.m_contourManager.components(components);
+
+    DetectionContext::FilterStatistics & statistics = _context.m_filterStatistics;
+    statistics.noiseCount = _context.m_contourManager.droppedCount();
+    statistics.shapeCount = components.size() + statistics.noiseCount;
 #if SD_TEST_DRAW
     //Drawing
     //Drawing vars
     cv::Scalar color;
 
-    Size originalSize(m_originalMat.cols,m_originalMat.rows);
+    Size originalSize(_context.m_originalMat.cols,_context.m_originalMat.rows);
 
     bool draw = (m_drawBoundings && originalSize.width && originalSize.height);
+
+    //Work Mat origin in boundings Mat: zone top left, or nothing when only the zone was given
+    Point drawOffset = _context.m_workOffset - _context.m_originalOffset;
 #if 1
     if (draw)
-        m_boundingsMat = m_originalMat.clone();
+        _context.m_boundingsMat = _context.m_originalMat.clone();
     else
-        m_boundingsMat = m_originalMat;
+        _context.m_boundingsMat = _context.m_originalMat;
 #else
-    if (draw) m_boundingsMat = cv::Mat::zeros(originalSize, CV_8UC3);
+    if (draw) _context.m_boundingsMat = cv::Mat::zeros(originalSize, CV_8UC3);
 #endif
 #endif//SD_TEST_DRAW
 
-    PointVector validMassCenters;
-    BoundingRectHash massCentersBoundingRects;
+    ComponentTable validComponents;
 
     cv::Size roiSize = m_pParams->zone.size();
     if (roiSize.width && roiSize.height)
     {
 #if SD_TEST_DRAW
-        if (draw) cv::rectangle(m_boundingsMat,m_pParams->zone.tl(),m_pParams->zone.br(),cv::Scalar(255,0,0),2,8,0);
-#endif//SD_TEST_DRAW
-        //Filtering mass centers.
-        for (ContourVector::size_type i = 0; i< contourSize; ++i)
-        {
-            //Object is in region of interest
-            if (m_pParams->zone.contains(massCenters[i]))
-            {
-#if SD_TEST_DRAW
-                if (draw) color = cv::Scalar(0,0,255);
+        if (draw) cv::rectangle(_context.m_boundingsMat,m_pParams->zone.tl() - _context.m_originalOffset,m_pParams->zone.br() - _context.m_originalOffset,cv::Scalar(255,0,0),2,8,0);
 #endif//SD_TEST_DRAW
-                cv::Size rectSize = boundingRects[i].size();
+        //Filtering mass centers: objects in region of interest, not too big
+        components.filter(_context.m_workZone,m_pParams->charMaxSize,validComponents);
+        statistics.zoneCount = components.size() - validComponents.size();
 
-                //Object not too big?
-                if (rectSize.width <= m_pParams->charMaxSize.width && rectSize.height <= m_pParams->charMaxSize.height)
-                {
 #if SD_TEST_DRAW
-                    if (draw)
-                    {
-                        cv::rectangle(m_boundingsMat, boundingRects[i].tl(), boundingRects[i].br(), color, 2, 8, 0);//contour bounding rect
-                        cv::circle(m_boundingsMat, massCenters[i], 4, color, -1, 8, 0);//mass center
-                    }//if (draw)
-#endif//SD_TEST_DRAW
-                    validMassCenters.push_back(massCenters[i]);
-
-                    //Associating mass center and his bounding rect
-                    massCentersBoundingRects.insert(massCenters[i],boundingRects[i]);
-
-                }//if (rectSize.width <= m_pParams->charMaxSize.width && rectSize.height <= m_pParams->charMaxSize.height)
-            }//if (m_pParams->zone.contains(massCenters[i]))
-        }//for (ContourVector::size_type i = 0; i< contourSize; ++i)
-
-        if (!validMassCenters.empty())
+        if (draw)
         {
-            //Sorting by X
-            std::sort(validMassCenters.begin(),validMassCenters.end(),&pointCompareAlongXAxis);
+            color = cv::Scalar(0,0,255);
 
-            //While there are points to deal with
-            do
+            for (int i = 0; i < validComponents.size(); ++i)
             {
-                CoordCountMap alignmentCountMap;
-
-                deepDebug3("Point list:");
-                //Building a count map for each different Y coordinate
-                for (PointVector::iterator it = validMassCenters.begin(); it != validMassCenters.end(); ++it)
-                {
-                    Point::value_type y = (*it).y;
+                const Rect & bounding = validComponents.boundings[i];
 
-                    deepDebug3("%d:%d",(*it).x,(*it).y);
-
-                    int alignmentCount = alignmentCountMap.value(y,0) +1;
-                    alignmentCountMap.insert(y,alignmentCount);
-                }//for (PointVector::iterator it = validMassCenters.begin(); it != validMassCenters.end(); ++it)
+                cv::rectangle(_context.m_boundingsMat, bounding.tl() + drawOffset, bounding.br() + drawOffset, color, 2, 8, 0);//contour bounding rect
+                cv::circle(_context.m_boundingsMat, validComponents.massCenters[i] + drawOffset, 4, color, -1, 8, 0);//mass center
+            }//for (int i = 0; i < validComponents.size(); ++i)
+        }//if (draw)
+#endif//SD_TEST_DRAW
 
-                deepDebug3("Map:");
-                for (CoordCountMap::const_iterator i = alignmentCountMap.begin(); i != alignmentCountMap.end(); ++i)
-                {
-                    deepDebug3("[%d,%d]",i.key(),*i);
-                }//for (CoordCountMap::const_iterator i = alignmentCountMap.begin(); i != alignmentCountMap.end(); ++i)
+        if (!validComponents.isEmpty())
+        {
+            TextLineGrouper grouper(m_lineGroupingMethod);
+            grouper.setTolerances(m_pParams->xTolerance,m_pParams->yTolerance);
 
-                int maxCount = 0;
+            TextLineGrouper::LineVector lines;
+            grouper.group(validComponents,lines);
 
-                CoordCountMap::const_iterator firstItem;
-                CoordCountMap::const_iterator lastItem;
+            for (TextLineGrouper::LineVector::size_type i = 0; i < lines.size(); ++i)
+            {
+                const Rect & lineRect = lines[i].rect;
+                int maxCount = lines[i].count;
 
-                bool stop;
+                Rect::value_type rectWidth = lineRect.width;
+                Rect::value_type rectHeight = lineRect.height;
 
-                deepDebug3("Searching best alignment...");
-                //Searching the biggest group of aligned points
-                for (CoordCountMap::const_iterator i = alignmentCountMap.begin(); i != alignmentCountMap.end(); ++i)
+                bool validRect = (maxCount > 2//If rect contains enough characters.
+                               && rectWidth > m_pParams->xTolerance *3//and rect is big enough
+                               && rectHeight >= (m_pParams->yTolerance / 10));
+#if SD_TEST_CENTERED
+                if (validRect && m_centered)
                 {
-                    stop = false;
-
-                    Point::value_type refY = i.key();
-                    int count = *i;
-
-                    if (count > maxCount)
-                    {
-                        maxCount = count;
-
-                        firstItem = i;
-                        lastItem = i;
-                    }//if (count > maxCount)
-
-                    deepDebug3("Count (i): %d",count);
-                    for (CoordCountMap::const_iterator j = i+1; j != alignmentCountMap.end() && !stop; ++j)
-                    {
-                        //If points with this Y coordinate are not in tolerance zone
-                        if ((j.key() - refY) > m_pParams->yTolerance)
-                        {
-                            stop = true;
-                        }//if ((j.key() - refY) > m_pParams->yTolerance)
-                        else
-                        {
-                            count += *j;
-                            deepDebug3("Count (j): %d",count);
-                            if (count > maxCount)
-                            {
-                                maxCount = count;
-
-                                firstItem = i;
-                                lastItem = j;
-                            }//if (count > maxCount)
-                        }//if ((j.key() - refY) > m_pParams->yTolerance)...else
-                    }//for (CoordCountMap::const_iterator j = i+1; j != alignmentCountMap.end() && !stop; ++j)
-                }//for (CoordCountMap::const_iterator i = alignmentCountMap.begin(); i != alignmentCountMap.end(); ++i)
-
-                deepDebug3("First item [%d,%d]",firstItem.key(),*firstItem);
-                deepDebug3("Last item [%d,%d]",lastItem.key(),*lastItem);
-
-                //Only one point?
-                if (maxCount == 1)
+                    double centeringRatio = static_cast<double>(_context.m_workZone.br().x - lineRect.br().x) / static_cast<double>(lineRect.x - _context.m_workZone.tl().x);
+                    deepDebug2("Centering ratio: %lf",centeringRatio);
+                    validRect = (centeringRatio > 0.8 && centeringRatio < 1.2);//20%
+
+                    if (!validRect) deepDebug2("Text is not centered.");
+                }//if (validRect && m_centered)
+#endif
+                if (!validRect)
                 {
-                    //No need to keep it, removing first (and only one)
-                    for (PointVector::iterator it = validMassCenters.begin(); it != validMassCenters.end(); ++it)
-                    {
-                        if ((*it).y == firstItem.key())
-                        {
-                            validMassCenters.erase(it);
-                            break;
-                        }//if ((*it).y == firstItem.key())
-                    }//for (PointVector::iterator it = validMassCenters.begin(); it != validMassCenters.end(); ++it)
-                }//if (maxCount == 1)
+                    deepDebug2("Invalid rect: count[%d] w[%d] h[%d]",maxCount,rectWidth,rectHeight);
+                    ++statistics.rejectedLineCount;
+                }//if (!validRect)
                 else
                 {
-                    Point::value_type lastX = UNDEFINED_COORD;
-                    Point::value_type currentX;
-                    bool validPoint;
-                    stop = false;
-
-                    Rect::value_type minX = std::numeric_limits<Rect::value_type>::max();
-                    Rect::value_type minY = std::numeric_limits<Rect::value_type>::max();
-                    Rect::value_type maxX = 0;
-                    Rect::value_type maxY = 0;
-
-                    deepDebug3("Building result:");
-                    //Building result
-                    for (PointVector::iterator it = validMassCenters.begin(); it != validMassCenters.end() && !stop;)
-                    {
-                        deepDebug3("%d:%d",(*it).x,(*it).y);
-
-                        validPoint = false;
-                        currentX = (*it).x;//Saving X coordinate for spacing check
-
-                        //Checking if point is in alignment range
-                        if ((*it).y >= firstItem.key() && (*it).y <= lastItem.key())
-                        {
-                            deepDebug3("Point is in range {%d,%d}",firstItem.key(),lastItem.key());
-
-                            //First point of this group?
-                            if (lastX == UNDEFINED_COORD)
-                            {
-                                deepDebug3("First");
-                                validPoint = true;
-                            }//if (lastX == UNDEFINED_COORD)
-                            else
-                            {
-                                deepDebug3("Current[%d] Last[%d]",currentX,lastX);
-                                //Is spacing correct?
-                                if ((currentX - lastX) <= m_pParams->xTolerance)
-                                {
-                                    deepDebug3("Correct spacing");
-                                    validPoint = true;
-                                }//if ((currentX - lastX) <= m_pParams->xTolerance)
-                                else
-                                {
-                                    //If this point is too far from the last one, the next ones will be too
-                                    stop = true;
-                                }//if ((currentX - lastX) <= m_pParams->xTolerance)...else
-                            }//if (lastX == UNDEFINED_COORD)...else
-                        }//if ((*it).y >= firstItem.key() && (*it).y <= lastItem.key())
-
-                        //Point is OK
-                        if (validPoint)
-                        {
-                            Rect tmpRect(massCentersBoundingRects.value((*it)));
-                            //Saving extrema
-                            if (tmpRect.tl().x < minX) minX = tmpRect.tl().x;
-                            if (tmpRect.tl().y < minY) minY = tmpRect.tl().y;
-                            if (tmpRect.br().x > maxX) maxX = tmpRect.br().x;
-                            if (tmpRect.br().y > maxY) maxY = tmpRect.br().y;
-
-                            //Saving X coordinate to check spacing
-                            lastX = currentX;
-
-                            //Removing it from the list
-                            it = validMassCenters.erase(it);
-                        }//if (validPoint)
-                        else
-                            ++it;
-                    }//for (PointVector::iterator it = validMassCenters.begin(); it != validMassCenters.end() && !stop;)
-
-                    Rect::value_type rectWidth = (maxX - minX);
-                    Rect::value_type rectHeight = (maxY - minY);
-
-                    bool validRect = (maxCount > 2//If rect contains enough characters.
-                                   && rectWidth > m_pParams->xTolerance *3//and rect is big enough
-                                   && rectHeight >= (m_pParams->yTolerance / 10));
-#if SD_TEST_CENTERED
-                    if (validRect && m_centered)
-                    {
-                        double centeringRatio = static_cast<double>(m_pParams->zone.br().x - maxX) / static_cast<double>(minX - m_pParams->zone.tl().x);
-                        deepDebug2("Centering ratio: %lf",centeringRatio);
-                        validRect = (centeringRatio > 0.8 && centeringRatio < 1.2);//20%
-
-                        if (!validRect) deepDebug2("Text is not centered.");
-                    }//if (validRect && m_centered)
-#endif
-                    if (!validRect)
-                    {
-                        deepDebug2("Invalid rect: count[%d] w[%d] h[%d]",maxCount,rectWidth,rectHeight);
-                    }//if (!validRect)
-                    else
-                    {
-                        deepDebug2("Valid rect: count[%d] w[%d] h[%d]",maxCount,rectWidth,rectHeight);
-                        _rects.push_back(Rect(minX,minY, rectWidth, rectHeight));
-                    }//if (!validRect)...else
-                }//if (maxCount == 1)...else
-             } while (!validMassCenters.empty());
+                    deepDebug2("Valid rect: count[%d] w[%d] h[%d]",maxCount,rectWidth,rectHeight);
+                    _rects.push_back(lineRect);
+                }//if (!validRect)...else
+            }//for (TextLineGrouper::LineVector::size_type i = 0; i < lines.size(); ++i)
 
             //Sorting rects from top to bottom of the image.
             if (!_rects.empty()) std::sort(_rects.begin(),_rects.end(),&rectCompareAlongYAxis);
-        }//if (!validMassCenters.empty())
+        }//if (!validComponents.isEmpty())
+
+        deepDebug2("Detector::getTextBoundingRects : %d shape(s), dropped %d as noise, %d by zone or size, %d line(s) rejected.",
+                   statistics.shapeCount,statistics.noiseCount,statistics.zoneCount,statistics.rejectedLineCount);
 #if SD_TEST_DRAW_RESULT
         if (draw)
         {
             for (RectVector::size_type i = 0; i < _rects.size(); ++i)
             {
-                cv::rectangle(m_boundingsMat,_rects[i],cv::Scalar(0,255,0),1,4);
+                cv::rectangle(_context.m_boundingsMat,_rects[i] + drawOffset,cv::Scalar(0,255,0),1,4);
             }//for (RectVector::size_type i = 0; i < _rects.size(); ++i)
         }//if (draw)
 #if SD_TEST_DRAW_BOUNDINGS_SEPARATE
         cv::namedWindow(WINDOW_NAME_BOUNDINGS, CV_WINDOW_NORMAL);
-        cv::imshow(WINDOW_NAME_BOUNDINGS, m_boundingsMat);
+        cv::imshow(WINDOW_NAME_BOUNDINGS, _context.m_boundingsMat);
 #endif//SD_TEST_DRAW_BOUNDINGS_SEPARATE
 #endif//SD_TEST_DRAW_RESULT
     }//if (roiSize.width && roiSize.height)
@@ -702,18 +1482,178 @@ void Detector::getTextBoundingRects(const ContourVector &_contours, RectVector &
 //------------------------------
 
 /*!
- * \brief Detector::blobContourSetup Fill _cmAttributes with Blob detection parameters.
- * \param _cmAttributes Output contour attributes.
+ * \brief Detector::recognizeLines Recognizes text in each of the text bounding rects. With incremental recognition,
+ *        lines already recognized on last change are not sent to OCR again. Then OCR cache is searched, if any.
+ *        Remaining lines are recognized concurrently when parallel recognition is enabled.
+ * \param _subtitles Output text, one item per line.
+ */
+void Detector::recognizeLines(QStringList & _subtitles, DetectionContext & _context) const
+{
+    RectVector::size_type lineCount = _context.m_boundingRects.size();
+
+    TextLineVector lines(lineCount);
+    std::vector<bool> reused(_context.m_textLines.size(),false);
+
+    IndexVector pendingLines;//Lines to be sent to OCR
+
+    for (RectVector::size_type i = 0; i < lineCount; ++i)
+    {
+        bool found = false;
+
+        if (m_incrementalRecognition || m_pOcrCache) lines[i].bits.pack(_context.m_threshMat(_context.m_boundingRects[i]));
+
+        if (m_incrementalRecognition)
+        {
+            //Searching an identical line in last recognized ones
+            for (TextLineVector::size_type j = 0; j < _context.m_textLines.size() && !found; ++j)
+            {
+                if (!reused[j]
+                 && _context.m_textLines[j].bits.hasSameSize(lines[i].bits)
+                 && !_context.m_textLines[j].bits.differenceCount(lines[i].bits))
+                {
+                    deepDebug2("Line %d has not changed.",static_cast<int>(i));
+
+                    lines[i].text = _context.m_textLines[j].text;
+                    reused[j] = true;
+                    found = true;
+                }//if (!reused[j]...
+            }//for (TextLineVector::size_type j = 0; j < _context.m_textLines.size() && !found; ++j)
+        }//if (m_incrementalRecognition)
+
+        if (!found && m_pOcrCache) found = m_pOcrCache->find(lines[i].bits,m_pOcrPool->tessdataParentPath(),m_pOcrPool->language(),lines[i].text);
+
+        if (!found) pendingLines.push_back(i);
+    }//for (RectVector::size_type i = 0; i < lineCount; ++i)
+
+    if (!pendingLines.empty())
+    {
+        OcrVector ocrs(1,m_pOcrPool->acquire());
+
+        //Extra engines are taken only if available at once
+        int engineCount = static_cast<int>(qMin(pendingLines.size(),static_cast<IndexVector::size_type>(m_recognitionThreads)));
+
+        while (static_cast<int>(ocrs.size()) < engineCount)
+        {
+            OpticalCharRecognizer * pOcr = m_pOcrPool->tryAcquire();
+
+            if (!pOcr) break;
+
+            ocrs.push_back(pOcr);
+        }//while (static_cast<int>(ocrs.size()) < engineCount)
+
+        if (ocrs.size() > 1)
+        {
+            recognizeLinesInParallel(pendingLines,ocrs,lines,_context);
+        }
+        else
+        {
+            ocrs[0]->setImage(_context.m_threshMat);
+
+            for (IndexVector::size_type i = 0; i < pendingLines.size(); ++i)
+            {
+                ocrs[0]->setRectangle(_context.m_boundingRects[pendingLines[i]]);
+                lines[pendingLines[i]].text = ocrs[0]->getUtf8Text();
+            }//for (IndexVector::size_type i = 0; i < pendingLines.size(); ++i)
+        }//else
+
+        for (OcrVector::size_type i = 0; i < ocrs.size(); ++i)
+        {
+            m_pOcrPool->release(ocrs[i]);
+        }//for (OcrVector::size_type i = 0; i < ocrs.size(); ++i)
+    }//if (!pendingLines.empty())
+
+    if (m_pOcrCache)
+    {
+        for (IndexVector::size_type i = 0; i < pendingLines.size(); ++i)
+        {
+            m_pOcrCache->insert(lines[pendingLines[i]].bits,m_pOcrPool->tessdataParentPath(),m_pOcrPool->language(),
+                                lines[pendingLines[i]].text);
+        }//for (IndexVector::size_type i = 0; i < pendingLines.size(); ++i)
+    }//if (m_pOcrCache)
+
+    for (RectVector::size_type i = 0; i < lineCount; ++i)
+    {
+        _subtitles.push_back(lines[i].text);
+    }//for (RectVector::size_type i = 0; i < lineCount; ++i)
+
+    if (m_incrementalRecognition) _context.m_textLines.swap(lines);
+}//recognizeLines
+
+//------------------------------
+
+/*!
+ * \brief Detector::recognizeLinesInParallel Recognizes _pendingLines concurrently. Lines are dealt out to the
+ *        recognizers in turn, each recognizer running in a thread of the global QThreadPool.
+ * \param _pendingLines Indexes of lines to be recognized.
+ * \param _ocrs Recognizers to use. At least two.
+ * \param _lines Output lines. Text of each pending line is set. Line order is kept.
  */
-void Detector::blobContourSetup(ContourManager::Attributes & _cmAttributes)
+void Detector::recognizeLinesInParallel(const IndexVector & _pendingLines, const OcrVector & _ocrs, TextLineVector & _lines,
+                                        const DetectionContext & _context) const
 {
-    m_contourManager.setBinThresh(m_pParams->thresh);
-    m_contourManager.setRetrievalMode(CV_RETR_CCOMP);
-    m_contourManager.setApproxMethod(CV_CHAIN_APPROX_NONE);
+    int taskCount = static_cast<int>(qMin(_pendingLines.size(),_ocrs.size()));
+
+    std::vector<RecognitionTask> tasks(taskCount);
+
+    for (int i = 0; i < taskCount; ++i)
+    {
+        tasks[i].pOcr = _ocrs[i];
+        tasks[i].pImage = &_context.m_threshMat;
+        tasks[i].pRects = &_context.m_boundingRects;
+        tasks[i].pLines = &_lines;
+    }//for (int i = 0; i < taskCount; ++i)
+
+    for (IndexVector::size_type i = 0; i < _pendingLines.size(); ++i)
+    {
+        tasks[i % taskCount].lineIndexes.push_back(_pendingLines[i]);
+    }//for (IndexVector::size_type i = 0; i < _pendingLines.size(); ++i)
+
+    QList<QFuture<void> > futures;
+
+    //First task runs in current thread
+    for (int i = 1; i < taskCount; ++i)
+    {
+        futures.append(QtConcurrent::run(&Detector::runRecognitionTask,tasks[i]));
+    }//for (int i = 1; i < taskCount; ++i)
 
-    m_contourManager.process(m_blobMat,ContourManager::SFBoundings | ContourManager::SFHierarchy);
+    runRecognitionTask(tasks[0]);
+
+    for (int i = 0; i < futures.size(); ++i)
+    {
+        futures[i].waitForFinished();
+    }//for (int i = 0; i < futures.size(); ++i)
+}//recognizeLinesInParallel
+
+//------------------------------
 
-    m_contourManager.attributes(_cmAttributes);
+/*!
+ * \brief Detector::runRecognitionTask Recognizes text of the lines of _task. Each task writes distinct lines.
+ */
+void Detector::runRecognitionTask(const RecognitionTask & _task)
+{
+    _task.pOcr->setImage(*_task.pImage);
+
+    for (IndexVector::size_type i = 0; i < _task.lineIndexes.size(); ++i)
+    {
+        IndexVector::value_type line = _task.lineIndexes[i];
+
+        _task.pOcr->setRectangle((*_task.pRects)[line]);
+        (*_task.pLines)[line].text = _task.pOcr->getUtf8Text();
+    }//for (IndexVector::size_type i = 0; i < _task.lineIndexes.size(); ++i)
+}//runRecognitionTask
+
+//------------------------------
+
+/*!
+ * \brief Detector::blobContourSetup Finds Blob Mat contours with Blob detection parameters, using the internal context contour manager.
+ */
+void Detector::blobContourSetup()
+{
+    m_context.m_contourManager.setBinThresh(m_pParams->thresh);
+    m_context.m_contourManager.setRetrievalMode(CV_RETR_CCOMP);
+    m_context.m_contourManager.setApproxMethod(CV_CHAIN_APPROX_NONE);
+
+    m_context.m_contourManager.process(m_blobMat,ContourManager::SFBoundings | ContourManager::SFHierarchy);
 }//blobContourSetup
 
 //-------------------------
@@ -735,11 +1675,11 @@ Detector::ReturnCode Detector::setBlobMat(const Mat & _image)
 /*!
  * \brief Detector::getPointedBlob : populate _pBlob attributes according to the blob at _point.
  * \warning Be sure that setBlobMat has been called before.
- * \param _cmAttributes Contours and bounding rects computed previously
+ * \param _contourManager Contours, child table and bounding rects computed previously
  * \param _point Pixel pointed.
  * \param _pBlob Pointer to Blob to be filled.
  */
-Detector::ReturnCode Detector::getPointedBlob(const ContourManager::Attributes & _cmAttributes, const Point & _point, BlobPtr & _pBlob)
+Detector::ReturnCode Detector::getPointedBlob(const ContourManager & _contourManager, const Point & _point, BlobPtr & _pBlob)
 {
     //Parameters must be set before
     if (!m_pParams)
@@ -750,9 +1690,13 @@ Detector::ReturnCode Detector::getPointedBlob(const ContourManager::Attributes &
 
     deepDebug("POINT[%d,%d]",_point.x,_point.y);
 
-    deepDebug("%d contour(s) retrieved.",_cmAttributes.contours.size());
+    const ContourStore & contours = _contourManager.contourStore();
+    const ChildIndexTable & childTable = _contourManager.childTable();
+    const RectVector & boundings = _contourManager.boundingRects();
+
+    deepDebug("%d contour(s) retrieved.",contours.size());
 
-    ContourVector::size_type contourSize = _cmAttributes.contours.size();
+    int contourSize = contours.size();
     ContourIndexList validIndexes;
 
     deepDebug("Retrieving contours which may contain the point...");
@@ -760,19 +1704,19 @@ Detector::ReturnCode Detector::getPointedBlob(const ContourManager::Attributes &
     deepDebug("Bounding rect(s) containing it:");
 
     //First pass: retrieving contours which may contain _point.
-    for (ContourVector::size_type i = 0; i < contourSize; ++i)
+    for (int i = 0; i < contourSize; ++i)
     {
-        if (_cmAttributes.boundings[i].contains(_point))
+        if (boundings[i].contains(_point))
         {
             deepDebug("  %d: X[%d] Y[%d] W[%d] H[%d]",
                       i,
-                      _cmAttributes.boundings[i].tl().x,
-                      _cmAttributes.boundings[i].tl().y,
-                      _cmAttributes.boundings[i].width,
-                      _cmAttributes.boundings[i].height);
+                      boundings[i].tl().x,
+                      boundings[i].tl().y,
+                      boundings[i].width,
+                      boundings[i].height);
             validIndexes.append(i);
         }//if (boundingRects[i].contains(_point))
-    }//for (ContourVector::size_type i = 0; i < contourSize; ++i)
+    }//for (int i = 0; i < contourSize; ++i)
 
     deepDebug("Retrieving contours which certainly contain the point...");
 
@@ -782,15 +1726,15 @@ Detector::ReturnCode Detector::getPointedBlob(const ContourManager::Attributes &
     for (ContourIndexList::size_type i = 0; i < validIndexes.size();)
     {
         //_point is inside or on an edge?
-        if (cv::pointPolygonTest(_cmAttributes.contours[validIndexes.at(i)],_point,false) >= 0.)
+        if (cv::pointPolygonTest(contours.view(validIndexes.at(i)),_point,false) >= 0.)
         {
             deepDebug("  %d contains it!",validIndexes.at(i));
             ++i;
-        }//if (cv::pointPolygonTest(_cmAttributes.contours[validIndexes.at(i)],_point,false) >= 0.)
+        }//if (cv::pointPolygonTest(contours.view(validIndexes.at(i)),_point,false) >= 0.)
         else
         {
             validIndexes.removeAt(i);
-        }//if (cv::pointPolygonTest(_cmAttributes.contours[validIndexes.at(i)],_point,false) >= 0.)...else
+        }//if (cv::pointPolygonTest(contours.view(validIndexes.at(i)),_point,false) >= 0.)...else
     }//for (ContourIndexList::size_type i = 0; i < validIndexes.size();)
 
     //If no contour left, exit.
@@ -825,7 +1769,7 @@ Detector::ReturnCode Detector::getPointedBlob(const ContourManager::Attributes &
         }//switch (m_bsbehavior)
 
         /*! Searching best candidate according chosen behavior.*/
-        bestChildCount = ContourManager::childCount(_cmAttributes.hierarchy,validIndexes.at(0));
+        bestChildCount = childTable.childCount(validIndexes.at(0));
         ContourIndexList::size_type chosenBlob = 0;
 
         deepDebug("Child count %d",bestChildCount);
@@ -833,7 +1777,7 @@ Detector::ReturnCode Detector::getPointedBlob(const ContourManager::Attributes &
         /* Choosing best blob according to selected behavior.*/
         for (ContourIndexList::size_type i = 1; i < validIndexes.size(); ++i)
         {
-            childCount = ContourManager::childCount(_cmAttributes.hierarchy,validIndexes.at(i));
+            childCount = childTable.childCount(validIndexes.at(i));
 
             deepDebug("Child count %d",childCount);
 
@@ -854,9 +1798,8 @@ Detector::ReturnCode Detector::getPointedBlob(const ContourManager::Attributes &
         validIndex = validIndexes.at(0);
     }//if (validIndexes.size() > 1)...else
 
-    //Copying to avoid multiple indexations.
-    Rect boundingRect = _cmAttributes.boundings[validIndex];
-    Contour contour = _cmAttributes.contours[validIndex];
+    //Avoiding multiple indexations.
+    Rect boundingRect = boundings[validIndex];
 
     deepDebug("BRECT TL [%d,%d] W %d H %d",boundingRect.tl().x,boundingRect.tl().y,boundingRect.width,boundingRect.height);
 
@@ -867,10 +1810,7 @@ Detector::ReturnCode Detector::getPointedBlob(const ContourManager::Attributes &
         return RC_INCONSISTENT;
     }//if (static_cast<float>(boundingRect.width) / static_cast<float>(m_blobMat.cols) > 0.20f...
 
-    ContourVector children;
-    ContourManager::children(_cmAttributes.contours,_cmAttributes.hierarchy,validIndex,children);
-
-    _pBlob->update(m_blobMat,boundingRect,contour,children);
+    _pBlob->update(m_blobMat,boundingRect,contours,childTable,validIndex);
 
     return RC_OK;
 }//getPointedBlob
@@ -20,13 +20,23 @@
 #ifndef SUBDETECTION_DETECTOR_H
 #define SUBDETECTION_DETECTOR_H
 
+#include <QAtomicInt>
+#include <QMutex>
 #include <QSharedPointer>
+#include <QString>
+#include <QStringList>
 
 #include "subdetection_global.h"
 #include "types.h"
 #include "parameters.h"
 #include "opticalcharrecognizer.h"
 #include "contourmanager.h"
+#include "detectioncontext.h"
+#include "hsvmasktable.h"
+#include "packedmask.h"
+#include "ocrcache.h"
+#include "ocrenginepool.h"
+#include "textlinegrouper.h"
 
 class QImage;
 
@@ -37,11 +47,14 @@ class Blob;
 
 /*!
  * \brief The Detector class. Subtitle detection class based on Tesseract-OCR.
+ *        Detection methods taking a DetectionContext are const and thread safe: once configured, a Detector can be
+ *        shared by several threads, each one with its own context. Other detection methods use an internal context.
  */
 class SUBDETECTIONSHARED_EXPORT Detector
 {
 public:
     typedef QSharedPointer<Blob> BlobPtr;
+    typedef QSharedPointer<OcrEnginePool> OcrEnginePoolPtr;
 
     enum ReturnCode
     {
@@ -62,6 +75,53 @@ public:
         BSB_INNER///< Always choose inner blob (default)
     };//BlobSelectionBehavior
 
+    /// How HSV range mask is computed
+    enum MaskingMethod
+    {
+        MM_CONVERSION,///< HSV conversion then range check (default)
+        MM_LOOKUP_TABLE///< Direct BGR to mask lookup. No HSV Mat is written.
+    };//MaskingMethod
+
+    /// How text zone changes are detected between two calls to "detect"
+    enum ChangeDetectionMethod
+    {
+        CDM_NORM,///< L2 norm between text zone masks, divided by zone area (default)
+        CDM_PACKED///< Ratio of differing pixels, computed on 1 bit per pixel masks
+    };//ChangeDetectionMethod
+
+    /// How text lines are found in the masked work Mat
+    enum LineFindingMethod
+    {
+        LFM_CONTOURS,///< Character shapes grouped into lines (default)
+        LFM_PROJECTION///< Row and column projection profiles of the text zone. Falls back to LFM_CONTOURS when ambiguous.
+    };//LineFindingMethod
+
+    /// Frame travelling through pipeline stages. See DetectionPipeline.
+    struct Frame
+    {
+        Frame(): id(0), result(RC_NO_RESULT) {}
+
+        qint64 id;///< Caller defined. Frame index or timestamp for example.
+        Mat image;///< Input image.
+        Mat threshMat;///< Work Mat mask. Set by mask stage, or by line stage when masked straight into runs.
+        RleMask runMask;///< Work Mat mask, when masked straight into runs. Set by mask stage.
+        RectVector boundingRects;///< Text lines in work Mat coordinates. Set by line stage.
+        QStringList subtitles;///< Set by recognition stage.
+        ReturnCode result;///< Same as "detect" return code.
+    };//Frame
+
+    /// Result of one frame of a batch. See detectBatch.
+    struct Result
+    {
+        Result(): result(RC_NO_RESULT) {}
+
+        ReturnCode result;///< Same as "detect" return code.
+        QStringList subtitles;
+        RectVector boundingRects;///< Text lines in image coordinates.
+    };//Result
+
+    typedef std::vector<Result> ResultVector;
+
     Detector();
     Detector(const QSharedPointer<Parameters> & _pParams);
     Detector(const Parameters & _params);
@@ -71,70 +131,175 @@ public:
 
     void setParameters(const QSharedPointer<Parameters> &  _pParams);
     void setParameters(const Parameters & _params);
+    /// Returns current parameters. Null if none has been set.
+    const QSharedPointer<Parameters> & parameters() const {return m_pParams;}
 
     void setBlobSelectionBehavior(BlobSelectionBehavior _behavior);
+    void setMaskingMethod(MaskingMethod _method);
+    void setChangeDetectionMethod(ChangeDetectionMethod _method);
+    void setExtractionMethod(ContourManager::ExtractionMethod _method);
+    void setContourInput(ContourManager::InputFormat _format);
+    void setLineGroupingMethod(TextLineGrouper::Method _method);
+    void setLineFindingMethod(LineFindingMethod _method);
     void enableBoundingsDrawing(bool _enabled);
+    void enableZoneProcessing(bool _enabled);
+    void enableIncrementalRecognition(bool _enabled);
+    void enableIncrementalExtraction(bool _enabled);
+
+    void setOcrCache(const QSharedPointer<OcrCache> & _pCache);
+    /// Returns the OCR result cache. Null if none.
+    const QSharedPointer<OcrCache> & ocrCache() const {return m_pOcrCache;}
+
+    void enableParallelRecognition(bool _enabled, int _maxThreads = 0);
+    void enableTiledProcessing(bool _enabled, int _maxThreads = 0);
+
+    void setOcrEnginePool(const OcrEnginePoolPtr & _pPool);
+    /// Returns the pool OCR engines are taken from.
+    const OcrEnginePoolPtr & ocrEnginePool() const {return m_pOcrPool;}
 
     void forget();
 
     ReturnCode detect(const Mat & _image, QStringList & _subtitles);
+    ReturnCode detect(const Mat & _image, QStringList & _subtitles, DetectionContext & _context) const;
+    ReturnCode detectZone(const Mat & _zoneImage, QStringList & _subtitles);
+    ReturnCode detectZone(const Mat & _zoneImage, QStringList & _subtitles, DetectionContext & _context) const;
+
+    void detectBatch(const std::vector<Mat> & _images, ResultVector & _results, int _maxThreads = 0) const;
+
+    void maskStage(Frame & _frame, DetectionContext & _context) const;
+    void lineStage(Frame & _frame, DetectionContext & _context) const;
+    void recognitionStage(Frame & _frame, DetectionContext & _context) const;
+
+    void textZoneMask(const Mat & _zoneImage, PackedMask & _bits) const;
+    bool textZonesMatch(const PackedMask & _first, const PackedMask & _second) const;
 
     ReturnCode getPointedBlob(const Mat & _image, const Point & _point, BlobPtr & _pBlob);
 
+    /// Returns the internal context, used by methods which do not take one.
+    const DetectionContext & context() const {return m_context;}
+
+    void textBoundingRects(RectVector & _rects) const;
+
 //    ReturnCode getSelectionParameters(const Rect & _roi, Parameters & _params);
 
-    /// After a call to "detect", returns the HSV representation of the original Mat.
-    const Mat & hsvMat() const {return m_hsvMat;}
-    /// After a call to "detect", returns the thresholded representation of the original Mat regarding HSV parameters.
-    const Mat & thresholdedMat() const {return m_threshMat;}
-    /// After a call to "detect", returns only the desired colors in the original Mat regarding HSV parameters.
-    const Mat & maskedMat() const {return m_maskedMat;}
+    /// After a call to "detect", returns the HSV representation of the original Mat. Zone sized if zone processing is enabled. Empty with MM_LOOKUP_TABLE.
+    const Mat & hsvMat() const {return m_context.hsvMat();}
+    /// After a call to "detect", returns the thresholded representation of the original Mat regarding HSV parameters. Zone sized if zone processing is enabled.
+    const Mat & thresholdedMat() const {return m_context.thresholdedMat();}
+    /// After a call to "detect", returns only the desired colors in the original Mat regarding HSV parameters. Zone sized if zone processing is enabled. Empty with ContourManager::EM_COMPONENTS, ContourManager::EM_RUNS or ContourManager::IF_BINARY.
+    const Mat & maskedMat() const {return m_context.maskedMat();}
     /// After a call to "detect", returns the thresholded text zone of the orignal Mat regarding HSV parameters.
-    const Mat & textZoneMat() const {return m_textZoneMat;}
+    const Mat & textZoneMat() const {return m_context.textZoneMat();}
     /// After a call to "detect", returns an image with contours of the orignal Mat regarding HSV parameters.
-    const Mat & contoursMat() const {return m_contourMat;}
+    const Mat & contoursMat() const {return m_context.contoursMat();}
     /// After a call to "detect", returns an image containing text zone and blob boundings.
-    const Mat & boundingsMat() const {return m_boundingsMat;}
+    const Mat & boundingsMat() const {return m_context.boundingsMat();}
+    /// After a call to "detect", returns how many shapes each filtering stage dropped.
+    const DetectionContext::FilterStatistics & filterStatistics() const {return m_context.filterStatistics();}
 
 protected:
+    typedef DetectionContext::TextLine TextLine;
+    typedef DetectionContext::TextLineVector TextLineVector;
+    typedef std::vector<OpticalCharRecognizer *> OcrVector;
+
+    /// Lines recognized by one OCR instance during parallel recognition.
+    struct RecognitionTask
+    {
+        OpticalCharRecognizer * pOcr;
+        const Mat * pImage;
+        const RectVector * pRects;
+        IndexVector lineIndexes;
+        TextLineVector * pLines;
+    };//RecognitionTask
+
+    /// Frames of a batch processed by one thread. Threads take the next unprocessed frame until none is left.
+    struct BatchTask
+    {
+        const Detector * pDetector;
+        const std::vector<Mat> * pImages;
+        ResultVector * pResults;
+        QAtomicInt * pNextFrame;
+    };//BatchTask
+
+    /// Horizontal band of an image masked by one thread during tiled processing. Mats are headers on caller's Mats.
+    struct MaskTask
+    {
+        const Detector * pDetector;
+        Mat image;
+        Mat mask;
+        Mat hsvMat;
+        const HsvMaskTable * pTable;///< Null with MM_CONVERSION.
+    };//MaskTask
+
     void createParameters();
 
+    void settingsChanged();
+    void checkSettings(DetectionContext & _context) const;
+
     ReturnCode checkImage(const Mat & _image) const;
+    ReturnCode setWorkMat(const Mat & _image, DetectionContext & _context) const;
+    bool zoneIsSet() const;
+    ReturnCode selectWorkMat(const Mat & _image, DetectionContext & _context) const;
+    ReturnCode processWorkMat(QStringList & _subtitles, DetectionContext & _context) const;
+    ReturnCode detectInWorkMat(QStringList & _subtitles, DetectionContext & _context) const;
+    bool maskWorkMat(DetectionContext & _context) const;
+    void setupContourManager(DetectionContext & _context) const;
+    void findTextRects(DetectionContext & _context) const;
+    bool findProjectedTextRects(DetectionContext & _context) const;
+    void decodeTextLines(DetectionContext & _context) const;
+    bool masksToRuns(const Mat & _image) const;
+    QSharedPointer<const HsvMaskTable> hsvMaskTable() const;
+    void hsvMask(const Mat & _image, Mat & _mask, Mat & _hsvMat) const;
+    void hsvMaskBand(const Mat & _image, Mat & _mask, Mat & _hsvMat, const HsvMaskTable * _pTable) const;
+    static void runMaskTask(const MaskTask & _task);
     bool compareImages(const Mat & _first, const Mat & _second) const;
+    bool compareMasks(const PackedMask & _first, const PackedMask & _second) const;
+    bool textZoneChanged(DetectionContext & _context) const;
+
+    void getTextBoundingRects(RectVector & _rects, DetectionContext & _context) const;
+
+    void recognizeLines(QStringList & _subtitles, DetectionContext & _context) const;
+    void recognizeLinesInParallel(const IndexVector & _pendingLines, const OcrVector & _ocrs, TextLineVector & _lines,
+                                  const DetectionContext & _context) const;
+    static void runRecognitionTask(const RecognitionTask & _task);
 
-    void getTextBoundingRects(const ContourVector & _contours, RectVector & _rects);
+    static void runBatchTask(const BatchTask & _task);
 
-    void blobContourSetup(ContourManager::Attributes & _cmAttributes);
+    void blobContourSetup();
 
     ReturnCode setBlobMat(const Mat & _image);
-    ReturnCode getPointedBlob(const ContourManager::Attributes & _cmAttributes, const Point & _point, BlobPtr & _pBlob);
+    ReturnCode getPointedBlob(const ContourManager & _contourManager, const Point & _point, BlobPtr & _pBlob);
 
     QSharedPointer<Parameters> m_pParams;
 
-    Mat m_originalMat;
-    Mat m_hsvMat;
-    Mat m_threshMat;
-    Mat m_textZoneMat;
-    Mat m_oldTextZoneMat;
-    Mat m_maskedMat;
-    Mat m_grayMat;
-    Mat m_contourMat;
-    Mat m_boundingsMat;
-
     Mat m_blobMat;
 
-    RectVector m_boundingRects;
-
     bool m_drawBoundings;
+    bool m_zoneProcessing;
+    bool m_incrementalRecognition;
+    bool m_incrementalExtraction;
 
-    OpticalCharRecognizer m_ocr;
+    OcrEnginePoolPtr m_pOcrPool;
+    QSharedPointer<OcrCache> m_pOcrCache;
+    int m_recognitionThreads;///< Maximum number of lines recognized at the same time.
+    int m_tileThreads;///< Maximum number of image bands masked and labeled at the same time.
 
-    ContourManager m_contourManager;
+    DetectionContext m_context;///< Used by methods which do not take a context.
+    int m_settingsVersion;///< Incremented when settings invalidate contexts history.
 
     bool m_centered;
-    bool m_forget;
 
     BlobSelectionBehavior m_bsbehavior;
+
+    MaskingMethod m_maskingMethod;
+    mutable QMutex m_hsvMaskTableMutex;
+    mutable QSharedPointer<const HsvMaskTable> m_pHsvMaskTable;///< Replaced, never modified, when HSV range changes.
+
+    ChangeDetectionMethod m_changeDetectionMethod;
+    ContourManager::ExtractionMethod m_extractionMethod;
+    ContourManager::InputFormat m_contourInput;
+    TextLineGrouper::Method m_lineGroupingMethod;
+    LineFindingMethod m_lineFindingMethod;
 };//SubDetector
 
 }//namespace SubDetection
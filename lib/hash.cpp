@@ -26,8 +26,11 @@ namespace cv
 
 uint qHash(const Point & _point)
 {
+    //x + y would make every point of an anti-diagonal collide
+    quint64 key = (static_cast<quint64>(static_cast<quint32>(_point.x)) << 32) | static_cast<quint32>(_point.y);
+
     // :: to help compiler understand that he must seek Qt qHash function elsewhere
-    return ::qHash(_point.x + _point.y);
+    return ::qHash(key);
 }//qHash
 
 }//cv
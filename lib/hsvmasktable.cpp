@@ -0,0 +1,194 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QString>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "deepdebug.h"
+
+#include "hsvmasktable.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+const int CHANNEL_LEVELS = 256;
+const int COLOR_COUNT = CHANNEL_LEVELS * CHANNEL_LEVELS * CHANNEL_LEVELS;
+const int BITS_PER_BYTE = 8;
+}//namespace
+
+HsvMaskTable::HsvMaskTable():
+    m_valid(false)
+{
+}//HsvMaskTable
+
+//-------------------------
+
+/*!
+ * \brief HsvMaskTable::isSupported Returns true if _bgrMat can be passed to apply: 8 bit BGR or BGRA.
+ * \param _bgrMat
+ */
+bool HsvMaskTable::isSupported(const Mat & _bgrMat)
+{
+    return (_bgrMat.type() == CV_8UC3 || _bgrMat.type() == CV_8UC4);
+}//isSupported
+
+//-------------------------
+
+/*!
+ * \brief HsvMaskTable::setRange Defines the HSV range. The table is rebuilt only if the range has changed.
+ * \param _min Lower bound, as passed to cv::inRange.
+ * \param _max Upper bound, as passed to cv::inRange.
+ */
+void HsvMaskTable::setRange(const Hsv & _min, const Hsv & _max)
+{
+    if (m_valid && m_min == _min && m_max == _max) return;
+
+    m_min = _min;
+    m_max = _max;
+
+    build();
+}//setRange
+
+//-------------------------
+
+/*!
+ * \brief HsvMaskTable::apply Computes the HSV range mask of _bgrMat in a single pass.
+ *        Table must be valid and _bgrMat supported. No control is made.
+ * \param _bgrMat Input 8 bit BGR or BGRA image.
+ * \param _mask Output CV_8UC1 mask: 255 if pixel is in range, 0 otherwise.
+ */
+void HsvMaskTable::apply(const Mat & _bgrMat, Mat & _mask) const
+{
+    _mask.create(_bgrMat.rows,_bgrMat.cols,CV_8UC1);
+
+    int channels = _bgrMat.channels();
+
+    for (int row = 0; row < _bgrMat.rows; ++row)
+    {
+        const uchar * pSrc = _bgrMat.ptr<uchar>(row);
+        uchar * pDst = _mask.ptr<uchar>(row);
+
+        for (int col = 0; col < _bgrMat.cols; ++col, pSrc += channels)
+        {
+            //0 -> 0x00, 1 -> 0xFF
+            pDst[col] = static_cast<uchar>(-static_cast<int>(contains(pSrc[0],pSrc[1],pSrc[2])));
+        }//for (int col = 0; col < _bgrMat.cols; ++col, pSrc += channels)
+    }//for (int row = 0; row < _bgrMat.rows; ++row)
+}//apply
+
+//-------------------------
+
+/*!
+ * \brief HsvMaskTable::apply Computes the HSV range mask of _bgrMat in a single pass, directly as runs: no mask Mat is written.
+ *        Table must be valid and _bgrMat supported. No control is made.
+ * \param _bgrMat Input 8 bit BGR or BGRA image.
+ * \param _runs Output runs of pixels in range.
+ */
+void HsvMaskTable::apply(const Mat & _bgrMat, RleMask & _runs) const
+{
+    _runs.reset(_bgrMat.rows,_bgrMat.cols);
+
+    int channels = _bgrMat.channels();
+
+    for (int row = 0; row < _bgrMat.rows; ++row)
+    {
+        const uchar * pSrc = _bgrMat.ptr<uchar>(row);
+        int first = -1;
+
+        for (int col = 0; col < _bgrMat.cols; ++col, pSrc += channels)
+        {
+            if (contains(pSrc[0],pSrc[1],pSrc[2]))
+            {
+                if (first < 0) first = col;
+            }//if (contains(pSrc[0],pSrc[1],pSrc[2]))
+            else if (first >= 0)
+            {
+                _runs.appendRun(first,col - first);
+                first = -1;
+            }//else if (first >= 0)
+        }//for (int col = 0; col < _bgrMat.cols; ++col, pSrc += channels)
+
+        if (first >= 0) _runs.appendRun(first,_bgrMat.cols - first);
+
+        _runs.endRow();
+    }//for (int row = 0; row < _bgrMat.rows; ++row)
+}//apply
+
+//-------------------------
+
+/*!
+ * \brief HsvMaskTable::build Builds the table one blue plane at a time, using OpenCV conversion
+ *        and range check so that lookups are bit-exact with them.
+ */
+void HsvMaskTable::build()
+{
+    deepDebug("HsvMaskTable::build : %s - %s",qPrintable(m_min.toString()),qPrintable(m_max.toString()));
+
+    m_bits.assign(COLOR_COUNT / BITS_PER_BYTE,0);
+
+    Mat bgrPlane(CHANNEL_LEVELS,CHANNEL_LEVELS,CV_8UC3);//Rows: green, cols: red
+    Mat hsvPlane;
+    Mat maskPlane;
+
+    Scalar lowerBound = m_min.toScalar();
+    Scalar upperBound = m_max.toScalar();
+
+    for (int blue = 0; blue < CHANNEL_LEVELS; ++blue)
+    {
+        for (int green = 0; green < CHANNEL_LEVELS; ++green)
+        {
+            cv::Vec3b * pColor = bgrPlane.ptr<cv::Vec3b>(green);
+
+            for (int red = 0; red < CHANNEL_LEVELS; ++red)
+            {
+                pColor[red] = cv::Vec3b(blue,green,red);
+            }//for (int red = 0; red < CHANNEL_LEVELS; ++red)
+        }//for (int green = 0; green < CHANNEL_LEVELS; ++green)
+
+        cv::cvtColor(bgrPlane,hsvPlane,cv::COLOR_BGR2HSV);
+        cv::inRange(hsvPlane,lowerBound,upperBound,maskPlane);
+
+        for (int green = 0; green < CHANNEL_LEVELS; ++green)
+        {
+            const uchar * pMask = maskPlane.ptr<uchar>(green);
+            quint8 * pBits = &m_bits[((blue << 16) | (green << 8)) / BITS_PER_BYTE];
+
+            for (int red = 0; red < CHANNEL_LEVELS; red += BITS_PER_BYTE)
+            {
+                quint8 byte = 0;
+
+                for (int bit = 0; bit < BITS_PER_BYTE; ++bit)
+                {
+                    if (pMask[red + bit]) byte |= (1 << bit);
+                }//for (int bit = 0; bit < BITS_PER_BYTE; ++bit)
+
+                pBits[red / BITS_PER_BYTE] = byte;
+            }//for (int red = 0; red < CHANNEL_LEVELS; red += BITS_PER_BYTE)
+        }//for (int green = 0; green < CHANNEL_LEVELS; ++green)
+    }//for (int blue = 0; blue < CHANNEL_LEVELS; ++blue)
+
+    m_valid = true;
+}//build
+
+//-------------------------
+
+}//namespace SubDetection
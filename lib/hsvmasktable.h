@@ -0,0 +1,77 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_HSVMASKTABLE_H
+#define SUBDETECTION_HSVMASKTABLE_H
+
+#include <vector>
+
+#include "subdetection_global.h"
+
+#include "hsv.h"
+#include "rlemask.h"
+#include "types.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The HsvMaskTable class. Maps a BGR pixel directly to its HSV range mask value.
+ *        One bit per BGR color (2 MB), built from OpenCV HSV conversion so results are the same as
+ *        cv::cvtColor followed by cv::inRange, without writing any HSV Mat.
+ */
+class SUBDETECTIONSHARED_EXPORT HsvMaskTable
+{
+public:
+    HsvMaskTable();
+
+    static bool isSupported(const Mat & _bgrMat);
+
+    bool isValid() const {return m_valid;}///< Returns true if the table has been built.
+
+    Hsv hsvMin() const {return m_min;}///< Returns lower bound of the HSV range.
+    Hsv hsvMax() const {return m_max;}///< Returns upper bound of the HSV range.
+
+    void setRange(const Hsv & _min, const Hsv & _max);
+
+    /// Returns true if BGR color is in HSV range. Table must be valid.
+    bool contains(uchar _b, uchar _g, uchar _r) const
+    {
+        quint32 index = (static_cast<quint32>(_b) << 16) | (static_cast<quint32>(_g) << 8) | _r;
+
+        return (m_bits[index >> 3] >> (index & 0x07)) & 0x01;
+    }//contains
+
+    void apply(const Mat & _bgrMat, Mat & _mask) const;
+    void apply(const Mat & _bgrMat, RleMask & _runs) const;
+
+protected:
+    void build();
+
+    Hsv m_min;
+    Hsv m_max;
+
+    bool m_valid;
+
+    std::vector<quint8> m_bits;
+};//HsvMaskTable
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_HSVMASKTABLE_H
@@ -15,6 +15,7 @@ MAJOR_VERSION = $$member(MAJOR_VERSION, 0)
 
 TARGET = subdetection
 TEMPLATE = lib
+QT += concurrent
 CONFIG += dll
 
 LIB_MAJOR_VERSION = "SUBDETECTION_MAJOR_VERSION = $${MAJOR_VERSION}"
@@ -34,35 +35,68 @@ INCLUDEPATH += .
 DEPENDPATH = $$INCLUDEPATH
 
 SOURCES += blob.cpp \
+    childindextable.cpp \
+    componentlabeler.cpp \
+    componenttable.cpp \
     contourmanager.cpp \
+    contourrasterizer.cpp \
+    contourstore.cpp \
     conversion.cpp \
+    detectioncontext.cpp \
+    detectionpipeline.cpp \
     detector.cpp \
     drawnblob.cpp \
     hash.cpp \
     hsv.cpp \
     hsvblob.cpp \
+    hsvmasktable.cpp \
     hsvlist.cpp \
+    ocrcache.cpp \
+    ocrenginepool.cpp \
     opticalcharrecognizer.cpp \
+    packedmask.cpp \
     parametermanager.cpp \
+    projectionlinefinder.cpp \
+    rlemask.cpp \
     statistical_tools.cpp \
-    subdetection_init.cpp
+    subdetection_init.cpp \
+    subtitlewriter.cpp \
+    textlinegrouper.cpp \
+    videosubtitleextractor.cpp
 
 HEADERS += blob.h \
+    childindextable.h \
+    componentlabeler.h \
+    componenttable.h \
     contourmanager.h \
+    contourrasterizer.h \
+    contourstore.h \
     conversion.h \
     deepdebug.h \
+    detectioncontext.h \
+    detectionpipeline.h \
     detector.h \
     drawnblob.h \
     hash.h \
     hsv.h \
     hsvtypes.h \
     hsvblob.h \
+    hsvmasktable.h \
     hsvlist.h \
+    ocrcache.h \
+    ocrenginepool.h \
     opticalcharrecognizer.h \
+    packedmask.h \
     parametermanager.h \
     parameters.h \
+    projectionlinefinder.h \
+    rlemask.h \
     rgbtable.h \
+    spscqueue.h \
     statistical_tools.h \
     subdetection_global.h \
     subdetection_init.h \
-    types.h
+    subtitlewriter.h \
+    textlinegrouper.h \
+    types.h \
+    videosubtitleextractor.h
@@ -0,0 +1,309 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "deepdebug.h"
+
+#include "ocrcache.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+const quint32 FILE_MAGIC = 0x5344434F;//"SDCO"
+const qint32 FILE_VERSION = 2;//2: tessdata parent path
+
+/// Approximate memory used by an entry.
+int entryCost(const PackedMask & _mask, const QString & _text)
+{
+    return _mask.byteSize() + _text.size() * static_cast<int>(sizeof(QChar)) + 64;
+}//entryCost
+}//namespace
+
+uint qHash(const OcrCache::Key & _key)
+{
+    return static_cast<uint>(_key.hash ^ (_key.hash >> 32)) ^ qHash(_key.tessdataParentPath) ^ qHash(_key.language);
+}//qHash
+
+//-------------------------
+
+/*!
+ * \brief OcrCache::OcrCache
+ * \param _maxBytes Memory budget. Least recently used entries are dropped when it is exceeded.
+ */
+OcrCache::OcrCache(int _maxBytes):
+    m_cache(_maxBytes),
+    m_hits(0),
+    m_misses(0),
+    m_useCount(0)
+{
+}//OcrCache
+
+//-------------------------
+
+int OcrCache::maxBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.maxCost();
+}//maxBytes
+
+//-------------------------
+
+void OcrCache::setMaxBytes(int _maxBytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(_maxBytes);
+}//setMaxBytes
+
+//-------------------------
+
+int OcrCache::totalBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.totalCost();
+}//totalBytes
+
+//-------------------------
+
+int OcrCache::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.count();
+}//count
+
+//-------------------------
+
+/*!
+ * \brief OcrCache::find Searches text recognized for _mask. Updates hit and miss counters.
+ * \param _mask Line mask.
+ * \param _tessdataParentPath Tesseract "tessdata" parent directory. Two directories may hold different models.
+ * \param _language Tesseract language.
+ * \param _text Output text. Unchanged if not found.
+ * \return true if found.
+ */
+bool OcrCache::find(const PackedMask & _mask, const QString & _tessdataParentPath, const QString & _language, QString & _text)
+{
+    Key key;
+    key.hash = _mask.hash();
+    key.tessdataParentPath = _tessdataParentPath;
+    key.language = _language;
+
+    QMutexLocker locker(&m_mutex);
+
+    Entry * pEntry = m_cache.object(key);
+
+    //Moved to the front, even on a hash collision
+    if (pEntry) pEntry->lastUse = ++m_useCount;
+
+    if (pEntry && pEntry->mask == _mask)
+    {
+        _text = pEntry->text;
+        ++m_hits;
+
+        return true;
+    }//if (pEntry && pEntry->mask == _mask)
+
+    ++m_misses;
+
+    return false;
+}//find
+
+//-------------------------
+
+/*!
+ * \brief OcrCache::insert Stores text recognized for _mask. Replaces any entry with the same key.
+ */
+void OcrCache::insert(const PackedMask & _mask, const QString & _tessdataParentPath, const QString & _language, const QString & _text)
+{
+    Entry * pEntry = new Entry;
+    pEntry->mask = _mask;
+    pEntry->text = _text;
+
+    QMutexLocker locker(&m_mutex);
+
+    insertEntry(_tessdataParentPath,_language,pEntry);
+}//insert
+
+//-------------------------
+
+void OcrCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}//clear
+
+//-------------------------
+
+int OcrCache::hits() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_hits;
+}//hits
+
+//-------------------------
+
+int OcrCache::misses() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_misses;
+}//misses
+
+//-------------------------
+
+void OcrCache::resetCounters()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_hits = 0;
+    m_misses = 0;
+}//resetCounters
+
+//-------------------------
+
+/*!
+ * \brief OcrCache::save Writes all entries to _filePath, from the least recently used one, so that load keeps their order.
+ *        Reading an entry moves it to the front of QCache: entries are read once to get their last use, then again from
+ *        the least recently used one, which leaves the order in which they will be dropped unchanged.
+ * \return false if file could not be written.
+ */
+bool OcrCache::save(const QString & _filePath) const
+{
+    QFile file(_filePath);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        deepDebug("OcrCache::save : cannot open %s",qPrintable(_filePath));
+        return false;
+    }//if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    QMutexLocker locker(&m_mutex);
+
+    QList<Key> keys = m_cache.keys();
+
+    //Last use and index in keys
+    std::vector<std::pair<quint64,int> > uses(keys.size());
+
+    for (int i = 0; i < keys.size(); ++i)
+    {
+        uses[i] = std::make_pair(m_cache.object(keys[i])->lastUse,i);
+    }//for (int i = 0; i < keys.size(); ++i)
+
+    std::sort(uses.begin(),uses.end());
+
+    stream << FILE_MAGIC << FILE_VERSION << static_cast<qint32>(keys.size());
+
+    for (std::vector<std::pair<quint64,int> >::size_type i = 0; i < uses.size(); ++i)
+    {
+        const Key & key = keys[uses[i].second];
+        const Entry * pEntry = m_cache.object(key);
+
+        stream << key.tessdataParentPath << key.language << pEntry->mask << pEntry->text;
+    }//for (std::vector<std::pair<quint64,int> >::size_type i = 0; i < uses.size(); ++i)
+
+    return (stream.status() == QDataStream::Ok);
+}//save
+
+//-------------------------
+
+/*!
+ * \brief OcrCache::load Adds entries read from _filePath. Counters are not modified.
+ * \return false if file could not be read or is not a valid cache file.
+ */
+bool OcrCache::load(const QString & _filePath)
+{
+    QFile file(_filePath);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        deepDebug("OcrCache::load : cannot open %s",qPrintable(_filePath));
+        return false;
+    }//if (!file.open(QIODevice::ReadOnly))
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 entryCount = 0;
+
+    stream >> magic >> version >> entryCount;
+
+    if (stream.status() != QDataStream::Ok || magic != FILE_MAGIC || version != FILE_VERSION || entryCount < 0)
+    {
+        deepDebug("OcrCache::load : %s is not a valid cache file.",qPrintable(_filePath));
+        return false;
+    }//if (stream.status() != QDataStream::Ok || ...
+
+    QMutexLocker locker(&m_mutex);
+
+    for (qint32 i = 0; i < entryCount; ++i)
+    {
+        QString tessdataParentPath;
+        QString language;
+        Entry * pEntry = new Entry;
+
+        stream >> tessdataParentPath >> language >> pEntry->mask >> pEntry->text;
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            delete pEntry;
+
+            deepDebug("OcrCache::load : %s is truncated.",qPrintable(_filePath));
+            return false;
+        }//if (stream.status() != QDataStream::Ok)
+
+        insertEntry(tessdataParentPath,language,pEntry);
+    }//for (qint32 i = 0; i < entryCount; ++i)
+
+    return true;
+}//load
+
+//-------------------------
+
+/*!
+ * \brief OcrCache::insertEntry Gives _pEntry to the cache. Mutex must be locked.
+ */
+void OcrCache::insertEntry(const QString & _tessdataParentPath, const QString & _language, Entry * _pEntry)
+{
+    Key key;
+    key.hash = _pEntry->mask.hash();
+    key.tessdataParentPath = _tessdataParentPath;
+    key.language = _language;
+
+    _pEntry->lastUse = ++m_useCount;
+
+    //QCache deletes the entry if it is too big
+    m_cache.insert(key,_pEntry,entryCost(_pEntry->mask,_pEntry->text));
+}//insertEntry
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,101 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_OCRCACHE_H
+#define SUBDETECTION_OCRCACHE_H
+
+#include <QCache>
+#include <QMutex>
+#include <QString>
+
+#include "subdetection_global.h"
+
+#include "packedmask.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The OcrCache class. Bounded LRU cache of recognized text, addressed by line mask content and Tesseract model:
+ *        tessdata parent path and language.
+ *        Masks are stored with text so a hash collision never returns a wrong text.
+ *        Thread safe: one cache may be shared by several Detector instances.
+ */
+class SUBDETECTIONSHARED_EXPORT OcrCache
+{
+public:
+    static const int DEFAULT_MAX_BYTES = 8 * 1024 * 1024;
+
+    explicit OcrCache(int _maxBytes = DEFAULT_MAX_BYTES);
+
+    int maxBytes() const;
+    void setMaxBytes(int _maxBytes);
+
+    int totalBytes() const;
+    int count() const;
+
+    bool find(const PackedMask & _mask, const QString & _tessdataParentPath, const QString & _language, QString & _text);
+    void insert(const PackedMask & _mask, const QString & _tessdataParentPath, const QString & _language, const QString & _text);
+
+    void clear();
+
+    int hits() const;
+    int misses() const;
+    void resetCounters();
+
+    bool save(const QString & _filePath) const;
+    bool load(const QString & _filePath);
+
+protected:
+    struct Key
+    {
+        quint64 hash;///< PackedMask::hash
+        QString tessdataParentPath;
+        QString language;
+
+        bool operator==(const Key & _other) const
+        {
+            return (hash == _other.hash && tessdataParentPath == _other.tessdataParentPath && language == _other.language);
+        }//operator==
+    };//Key
+
+    struct Entry
+    {
+        PackedMask mask;
+        QString text;
+        quint64 lastUse;///< Value of m_useCount when the entry was last inserted or looked up.
+    };//Entry
+
+    friend uint qHash(const Key & _key);
+
+    void insertEntry(const QString & _tessdataParentPath, const QString & _language, Entry * _pEntry);
+
+    mutable QMutex m_mutex;
+
+    QCache<Key,Entry> m_cache;
+
+    int m_hits;
+    int m_misses;
+
+    quint64 m_useCount;///< Incremented each time QCache moves an entry to the front.
+};//OcrCache
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_OCRCACHE_H
@@ -0,0 +1,289 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QHash>
+#include <QMutexLocker>
+#include <QPair>
+#include <QThread>
+
+#include "deepdebug.h"
+#include "opticalcharrecognizer.h"
+
+#include "ocrenginepool.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+    typedef QPair<QString,QString> PoolKey;//tessdata parent path, language
+
+    QMutex sharedPoolsMutex;
+    QHash<PoolKey,QSharedPointer<OcrEnginePool> > sharedPools;
+}//namespace
+
+/*!
+ * \brief OcrEnginePool::OcrEnginePool Creates _minSize engines at once.
+ * \param _tessdataParentPath : tesseract "tessdata" parent directory.
+ * \param _lang : language. Be sure that corresponding language files are available in tessdata directory.
+ * \param _minSize Number of engines kept loaded.
+ * \param _maxSize Maximum number of engines. 0: ideal thread count.
+ */
+OcrEnginePool::OcrEnginePool(const QString & _tessdataParentPath, const QString & _lang, int _minSize, int _maxSize):
+    m_tessdataParentPath(_tessdataParentPath),
+    m_language(_lang),
+    m_minSize(qMax(_minSize,0)),
+    m_maxSize(_maxSize > 0 ? _maxSize : qMax(QThread::idealThreadCount(),1)),
+    m_engineCount(0)
+{
+    if (m_minSize > m_maxSize) m_maxSize = m_minSize;
+
+    preload();
+}//OcrEnginePool
+
+//-------------------------
+
+OcrEnginePool::~OcrEnginePool()
+{
+    if (m_engineCount != m_idleEngines.size())
+    {
+        deepDebug("OcrEnginePool::~OcrEnginePool : %d engine(s) not released.",m_engineCount - m_idleEngines.size());
+    }//if (m_engineCount != m_idleEngines.size())
+
+    qDeleteAll(m_idleEngines);
+}//~OcrEnginePool
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::shared Returns the process wide pool for _tessdataParentPath and _lang. The pool is created
+ *        on first call and kept until clearShared is called.
+ */
+QSharedPointer<OcrEnginePool> OcrEnginePool::shared(const QString & _tessdataParentPath, const QString & _lang)
+{
+    QMutexLocker locker(&sharedPoolsMutex);
+
+    PoolKey key = qMakePair(_tessdataParentPath,_lang);
+
+    QSharedPointer<OcrEnginePool> & pPool = sharedPools[key];
+
+    if (!pPool) pPool = QSharedPointer<OcrEnginePool>(new OcrEnginePool(_tessdataParentPath,_lang));
+
+    return pPool;
+}//shared
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::clearShared Forgets shared pools. Each pool is destroyed when no one uses it anymore.
+ */
+void OcrEnginePool::clearShared()
+{
+    QMutexLocker locker(&sharedPoolsMutex);
+
+    sharedPools.clear();
+}//clearShared
+
+//-------------------------
+
+int OcrEnginePool::minimumSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_minSize;
+}//minimumSize
+
+//-------------------------
+
+int OcrEnginePool::maximumSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxSize;
+}//maximumSize
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::setMinimumSize Sets the number of engines kept loaded. Missing engines are created at once.
+ *        Maximum size is raised if needed.
+ */
+void OcrEnginePool::setMinimumSize(int _minSize)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+
+        m_minSize = qMax(_minSize,0);
+
+        if (m_minSize > m_maxSize) m_maxSize = m_minSize;
+    }
+
+    preload();
+}//setMinimumSize
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::setMaximumSize Sets the maximum number of engines. Exceeding idle engines are destroyed at
+ *        once, acquired ones when released. Minimum size is lowered if needed. Raising it wakes threads waiting in acquire.
+ */
+void OcrEnginePool::setMaximumSize(int _maxSize)
+{
+    QList<OpticalCharRecognizer *> exceedingEngines;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        int oldMaxSize = m_maxSize;
+        m_maxSize = qMax(_maxSize,1);
+
+        //Waiting threads may create engines now
+        if (m_maxSize > oldMaxSize) m_engineReleased.wakeAll();
+
+        if (m_minSize > m_maxSize) m_minSize = m_maxSize;
+
+        while (m_engineCount > m_maxSize && !m_idleEngines.isEmpty())
+        {
+            exceedingEngines.append(m_idleEngines.takeLast());
+            --m_engineCount;
+        }//while (m_engineCount > m_maxSize && !m_idleEngines.isEmpty())
+    }
+
+    qDeleteAll(exceedingEngines);
+}//setMaximumSize
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::size Returns the number of engines created, idle or acquired.
+ */
+int OcrEnginePool::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_engineCount;
+}//size
+
+//-------------------------
+
+int OcrEnginePool::idleCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_idleEngines.size();
+}//idleCount
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::acquire Returns an engine. Waits for a release if maximum size has been reached.
+ *        The engine must be given back with release.
+ */
+OpticalCharRecognizer * OcrEnginePool::acquire()
+{
+    return acquireEngine(true);
+}//acquire
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::tryAcquire Returns an engine, or 0 if maximum size has been reached and none is idle.
+ *        The engine must be given back with release.
+ */
+OpticalCharRecognizer * OcrEnginePool::tryAcquire()
+{
+    return acquireEngine(false);
+}//tryAcquire
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::release Gives back an engine returned by acquire or tryAcquire.
+ */
+void OcrEnginePool::release(OpticalCharRecognizer * _pEngine)
+{
+    if (!_pEngine) return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (m_engineCount <= m_maxSize)
+        {
+            m_idleEngines.append(_pEngine);
+            m_engineReleased.wakeOne();
+            return;
+        }//if (m_engineCount <= m_maxSize)
+
+        //Maximum size has been lowered
+        --m_engineCount;
+
+        //A waiting thread may create an engine if maximum size is not exceeded anymore
+        if (m_engineCount < m_maxSize) m_engineReleased.wakeOne();
+    }
+
+    delete _pEngine;
+}//release
+
+//-------------------------
+
+OpticalCharRecognizer * OcrEnginePool::acquireEngine(bool _wait)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (_wait && m_idleEngines.isEmpty() && m_engineCount >= m_maxSize)
+    {
+        m_engineReleased.wait(&m_mutex);
+    }//while (_wait && m_idleEngines.isEmpty() && m_engineCount >= m_maxSize)
+
+    if (!m_idleEngines.isEmpty()) return m_idleEngines.takeLast();
+
+    if (m_engineCount >= m_maxSize) return 0;
+
+    ++m_engineCount;
+
+    //Tesseract initialization is long: other threads may use the pool meanwhile.
+    locker.unlock();
+
+    deepDebug2("OcrEnginePool::acquireEngine : creating engine for %s.",qPrintable(m_language));
+
+    return new OpticalCharRecognizer(m_tessdataParentPath,m_language);
+}//acquireEngine
+
+//-------------------------
+
+/*!
+ * \brief OcrEnginePool::preload Creates engines until minimum size is reached.
+ */
+void OcrEnginePool::preload()
+{
+    bool missing = true;
+
+    while (missing)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+
+            missing = (m_engineCount < m_minSize);
+
+            if (missing) ++m_engineCount;
+        }
+
+        if (missing) release(new OpticalCharRecognizer(m_tessdataParentPath,m_language));
+    }//while (missing)
+}//preload
+
+//-------------------------
+
+}//namespace SubDetection
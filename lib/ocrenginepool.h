@@ -0,0 +1,88 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_OCRENGINEPOOL_H
+#define SUBDETECTION_OCRENGINEPOOL_H
+
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QWaitCondition>
+
+#include "subdetection_global.h"
+
+namespace SubDetection
+{
+
+class OpticalCharRecognizer;
+
+/*!
+ * \brief The OcrEnginePool class. Pool of OpticalCharRecognizer sharing the same tessdata path and language.
+ *        Engines are created on demand up to the maximum size and reused afterwards, so Tesseract language data is
+ *        loaded only once per engine. Thread safe.
+ * \warning Every acquired engine must be released before the pool is destroyed.
+ */
+class SUBDETECTIONSHARED_EXPORT OcrEnginePool
+{
+public:
+    OcrEnginePool(const QString & _tessdataParentPath, const QString & _lang, int _minSize = 1, int _maxSize = 0);
+    ~OcrEnginePool();
+
+    static QSharedPointer<OcrEnginePool> shared(const QString & _tessdataParentPath, const QString & _lang);
+    static void clearShared();
+
+    const QString & tessdataParentPath() const {return m_tessdataParentPath;}///< Returns "tessdata" parent directory.
+    const QString & language() const {return m_language;}///< Returns Tesseract language.
+
+    int minimumSize() const;
+    int maximumSize() const;
+    void setMinimumSize(int _minSize);
+    void setMaximumSize(int _maxSize);
+
+    int size() const;
+    int idleCount() const;
+
+    OpticalCharRecognizer * acquire();
+    OpticalCharRecognizer * tryAcquire();
+    void release(OpticalCharRecognizer * _pEngine);
+
+protected:
+    OpticalCharRecognizer * acquireEngine(bool _wait);
+    void preload();
+
+    const QString m_tessdataParentPath;
+    const QString m_language;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_engineReleased;
+
+    int m_minSize;
+    int m_maxSize;
+    int m_engineCount;///< Engines created, idle or acquired.
+
+    QList<OpticalCharRecognizer *> m_idleEngines;
+
+private:
+    Q_DISABLE_COPY(OcrEnginePool)
+};//OcrEnginePool
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_OCRENGINEPOOL_H
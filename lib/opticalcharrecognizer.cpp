@@ -27,7 +27,9 @@
 namespace SubDetection
 {
 
-OpticalCharRecognizer::OpticalCharRecognizer(const QString & _tessdataParentPath, const QString & _lang)
+OpticalCharRecognizer::OpticalCharRecognizer(const QString & _tessdataParentPath, const QString & _lang):
+    m_tessdataParentPath(_tessdataParentPath),
+    m_language(_lang)
 {
     m_tess.Init(_tessdataParentPath.toLocal8Bit().constData(), _lang.toLocal8Bit().constData(), tesseract::OEM_DEFAULT);
     // m_tess.SetPageSegMode(tesseract::PSM_SINGLE_BLOCK);
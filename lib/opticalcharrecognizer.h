@@ -21,12 +21,12 @@
 #define SUBDETECTION_OCR_H
 
 #include <QtGlobal>
+#include <QString>
 
 #include <api/baseapi.h>
 
 #include "subdetection_global.h"
 
-class QString;
 class Rect;
 class Mat;
 
@@ -50,8 +50,13 @@ public:
 
     QString getUtf8Text();
 
+    const QString & tessdataParentPath() const {return m_tessdataParentPath;}///< Returns "tessdata" parent directory.
+    const QString & language() const {return m_language;}///< Returns the language Tesseract was initialized with.
+
 protected:
     tesseract::TessBaseAPI m_tess;
+    QString m_tessdataParentPath;
+    QString m_language;
 };//OpticalCharRecognizer
 
 }//namespace SubDetection
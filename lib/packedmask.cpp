@@ -0,0 +1,347 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include <QDataStream>
+
+#include "rlemask.h"
+
+#include "packedmask.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+const int WORD_BITS = 64;
+const int BYTE_BITS = 8;
+
+const quint64 LOW_7_BITS = Q_UINT64_C(0x7F7F7F7F7F7F7F7F);
+const quint64 HIGH_BITS = Q_UINT64_C(0x8080808080808080);
+const quint64 GATHER_HIGH_BITS = Q_UINT64_C(0x0002040810204081);
+
+const quint64 FNV_OFFSET_BASIS = Q_UINT64_C(0xCBF29CE484222325);
+const quint64 FNV_PRIME = Q_UINT64_C(0x00000100000001B3);
+
+/// FNV-1a step, one 64 bits word at a time.
+inline quint64 hashWord(quint64 _hash, quint64 _word)
+{
+    return (_hash ^ _word) * FNV_PRIME;
+}//hashWord
+
+/// Returns the number of bits set in _word.
+inline int popCount(quint64 _word)
+{
+#if defined(Q_CC_GNU)
+    return __builtin_popcountll(_word);
+#else
+    _word = _word - ((_word >> 1) & Q_UINT64_C(0x5555555555555555));
+    _word = (_word & Q_UINT64_C(0x3333333333333333)) + ((_word >> 2) & Q_UINT64_C(0x3333333333333333));
+    _word = (_word + (_word >> 4)) & Q_UINT64_C(0x0F0F0F0F0F0F0F0F);
+
+    return static_cast<int>((_word * Q_UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}//popCount
+
+//-------------------------
+
+/// Packs 8 mask bytes into 8 bits. Bit i is set if byte i is not null.
+inline quint8 packByte(const uchar * _pBytes)
+{
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    quint64 bytes;
+    std::memcpy(&bytes,_pBytes,sizeof(bytes));
+
+    //High bit of each byte is set if byte is not null, then high bits are gathered in the top byte.
+    quint64 highBits = (((bytes & LOW_7_BITS) + LOW_7_BITS) | bytes) & HIGH_BITS;
+
+    return static_cast<quint8>((highBits * GATHER_HIGH_BITS) >> 56);
+#else
+    quint8 result = 0;
+
+    for (int i = 0; i < BYTE_BITS; ++i)
+    {
+        if (_pBytes[i]) result |= (1 << i);
+    }//for (int i = 0; i < BYTE_BITS; ++i)
+
+    return result;
+#endif
+}//packByte
+}//namespace
+
+PackedMask::PackedMask():
+    m_rows(0),
+    m_cols(0),
+    m_wordsPerRow(0)
+{
+}//PackedMask
+
+//-------------------------
+
+/*!
+ * \brief PackedMask::pack Packs _mask. Every non null pixel is set. Previous buffer is reused if big enough.
+ * \param _mask Input CV_8UC1 mask. May be a ROI.
+ */
+void PackedMask::pack(const Mat & _mask)
+{
+    m_rows = _mask.rows;
+    m_cols = _mask.cols;
+    m_wordsPerRow = (m_cols + WORD_BITS - 1) / WORD_BITS;
+
+    m_words.assign(m_rows * m_wordsPerRow,0);
+
+    int fullBytes = m_cols / BYTE_BITS;
+
+    for (int row = 0; row < m_rows; ++row)
+    {
+        const uchar * pPixels = _mask.ptr<uchar>(row);
+        Word * pWords = &m_words[row * m_wordsPerRow];
+
+        for (int byte = 0; byte < fullBytes; ++byte)
+        {
+            pWords[byte / BYTE_BITS] |= static_cast<Word>(packByte(pPixels + byte * BYTE_BITS)) << ((byte % BYTE_BITS) * BYTE_BITS);
+        }//for (int byte = 0; byte < fullBytes; ++byte)
+
+        //Remaining pixels
+        for (int col = fullBytes * BYTE_BITS; col < m_cols; ++col)
+        {
+            if (pPixels[col]) pWords[col / WORD_BITS] |= static_cast<Word>(1) << (col % WORD_BITS);
+        }//for (int col = fullBytes * BYTE_BITS; col < m_cols; ++col)
+    }//for (int row = 0; row < m_rows; ++row)
+}//pack
+
+//-------------------------
+
+/*!
+ * \brief PackedMask::pack Packs the _roi part of a run-length encoded mask. Same result as packing the decoded ROI,
+ *        but only runs are read: no mask Mat is needed.
+ * \param _runs Input runs.
+ * \param _roi Part of _runs to pack. Must lie inside _runs. No control is made.
+ */
+void PackedMask::pack(const RleMask & _runs, const Rect & _roi)
+{
+    m_rows = _roi.height;
+    m_cols = _roi.width;
+    m_wordsPerRow = (m_cols + WORD_BITS - 1) / WORD_BITS;
+
+    m_words.assign(m_rows * m_wordsPerRow,0);
+
+    const RleMask::RunVector & runs = _runs.runs();
+    int roiEnd = _roi.x + _roi.width;
+
+    for (int row = 0; row < m_rows; ++row)
+    {
+        Word * pWords = &m_words[row * m_wordsPerRow];
+
+        int first = _runs.rowOffset(_roi.y + row);
+        int end = first + _runs.rowRunCount(_roi.y + row);
+
+        for (int i = first; i < end; ++i)
+        {
+            //Run clipped to the ROI, in ROI coordinates
+            int col = std::max(runs[i].x,_roi.x) - _roi.x;
+            int colEnd = std::min(runs[i].x + runs[i].length,roiEnd) - _roi.x;
+
+            while (col < colEnd)
+            {
+                int bit = col % WORD_BITS;
+                int bitCount = std::min(colEnd - col,WORD_BITS - bit);
+
+                Word bits = (bitCount == WORD_BITS) ? ~static_cast<Word>(0) : (static_cast<Word>(1) << bitCount) - 1;
+                pWords[col / WORD_BITS] |= bits << bit;
+
+                col += bitCount;
+            }//while (col < colEnd)
+        }//for (int i = first; i < end; ++i)
+    }//for (int row = 0; row < m_rows; ++row)
+}//pack RleMask
+
+//-------------------------
+
+void PackedMask::clear()
+{
+    m_rows = 0;
+    m_cols = 0;
+    m_wordsPerRow = 0;
+
+    m_words.clear();
+}//clear
+
+//-------------------------
+
+bool PackedMask::hasSameSize(const PackedMask & _other) const
+{
+    return (m_rows == _other.rows() && m_cols == _other.cols());
+}//hasSameSize
+
+//-------------------------
+
+/*!
+ * \brief PackedMask::operator== Returns true if both masks have the same size and the same pixels set.
+ */
+bool PackedMask::operator==(const PackedMask & _other) const
+{
+    return (hasSameSize(_other) && m_words == _other.m_words);
+}//operator==
+
+//-------------------------
+
+/*!
+ * \brief PackedMask::hash Returns a 64 bits hash of the mask size and content. Equal masks have equal hashes.
+ */
+quint64 PackedMask::hash() const
+{
+    quint64 result = hashWord(FNV_OFFSET_BASIS,static_cast<quint64>(m_rows));
+    result = hashWord(result,static_cast<quint64>(m_cols));
+
+    for (std::vector<Word>::size_type i = 0; i < m_words.size(); ++i)
+    {
+        result = hashWord(result,m_words[i]);
+    }//for (std::vector<Word>::size_type i = 0; i < m_words.size(); ++i)
+
+    return result;
+}//hash
+
+//-------------------------
+
+/*!
+ * \brief PackedMask::byteSize Returns the memory used by packed pixels, in bytes.
+ */
+int PackedMask::byteSize() const
+{
+    return static_cast<int>(m_words.size() * sizeof(Word));
+}//byteSize
+
+//-------------------------
+
+/*!
+ * \brief PackedMask::count Returns the number of set pixels.
+ */
+int PackedMask::count() const
+{
+    int result = 0;
+
+    for (std::vector<Word>::size_type i = 0; i < m_words.size(); ++i)
+    {
+        result += popCount(m_words[i]);
+    }//for (std::vector<Word>::size_type i = 0; i < m_words.size(); ++i)
+
+    return result;
+}//count
+
+//-------------------------
+
+/*!
+ * \brief PackedMask::differenceCount Returns the number of pixels which differ between the two masks.
+ *        Masks must have the same size. No control is made.
+ * \param _other
+ */
+int PackedMask::differenceCount(const PackedMask & _other) const
+{
+    int result = 0;
+
+    const Word * pWords = m_words.empty() ? 0 : &m_words[0];
+    const Word * pOtherWords = _other.isEmpty() ? 0 : _other.row(0);
+
+    std::vector<Word>::size_type wordCount = m_words.size();
+
+    for (std::vector<Word>::size_type i = 0; i < wordCount; ++i)
+    {
+        result += popCount(pWords[i] ^ pOtherWords[i]);
+    }//for (std::vector<Word>::size_type i = 0; i < wordCount; ++i)
+
+    return result;
+}//differenceCount
+
+//-------------------------
+
+/*!
+ * \brief PackedMask::differenceRatio Returns the ratio of pixels which differ between the two masks. 0 <= ratio <= 1.
+ *        Masks must have the same size. No control is made.
+ * \param _other
+ */
+double PackedMask::differenceRatio(const PackedMask & _other) const
+{
+    int pixelCount = m_rows * m_cols;
+
+    if (!pixelCount) return 0.;
+
+    return static_cast<double>(differenceCount(_other)) / static_cast<double>(pixelCount);
+}//differenceRatio
+
+//-------------------------
+
+void PackedMask::swap(PackedMask & _other)
+{
+    std::swap(m_rows,_other.m_rows);
+    std::swap(m_cols,_other.m_cols);
+    std::swap(m_wordsPerRow,_other.m_wordsPerRow);
+
+    m_words.swap(_other.m_words);
+}//swap
+
+//-------------------------
+
+QDataStream & operator<<(QDataStream & _stream, const PackedMask & _mask)
+{
+    _stream << static_cast<qint32>(_mask.m_rows) << static_cast<qint32>(_mask.m_cols);
+
+    for (std::vector<PackedMask::Word>::size_type i = 0; i < _mask.m_words.size(); ++i)
+    {
+        _stream << static_cast<quint64>(_mask.m_words[i]);
+    }//for (std::vector<PackedMask::Word>::size_type i = 0; i < _mask.m_words.size(); ++i)
+
+    return _stream;
+}//operator<<
+
+//-------------------------
+
+QDataStream & operator>>(QDataStream & _stream, PackedMask & _mask)
+{
+    qint32 rows = 0;
+    qint32 cols = 0;
+
+    _stream >> rows >> cols;
+
+    _mask.clear();
+
+    if (_stream.status() != QDataStream::Ok || rows < 0 || cols < 0) return _stream;
+
+    _mask.m_rows = rows;
+    _mask.m_cols = cols;
+    _mask.m_wordsPerRow = (cols + WORD_BITS - 1) / WORD_BITS;
+    _mask.m_words.resize(rows * _mask.m_wordsPerRow);
+
+    for (std::vector<PackedMask::Word>::size_type i = 0; i < _mask.m_words.size() && _stream.status() == QDataStream::Ok; ++i)
+    {
+        quint64 word = 0;
+        _stream >> word;
+        _mask.m_words[i] = word;
+    }//for (std::vector<PackedMask::Word>::size_type i = 0; ...
+
+    if (_stream.status() != QDataStream::Ok) _mask.clear();
+
+    return _stream;
+}//operator>>
+
+//-------------------------
+
+}//namespace SubDetection
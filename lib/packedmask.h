@@ -0,0 +1,86 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_PACKEDMASK_H
+#define SUBDETECTION_PACKEDMASK_H
+
+#include <vector>
+
+#include "subdetection_global.h"
+
+#include "types.h"
+
+class QDataStream;
+
+namespace SubDetection
+{
+
+class RleMask;
+
+/*!
+ * \brief The PackedMask class. Binary mask stored at 1 bit per pixel. Each row starts on a new word.
+ *        Two masks of the same size are compared with XOR and population count.
+ */
+class SUBDETECTIONSHARED_EXPORT PackedMask
+{
+public:
+    typedef quint64 Word;
+
+    PackedMask();
+
+    void pack(const Mat & _mask);
+    void pack(const RleMask & _runs, const Rect & _roi);
+    void clear();
+
+    bool isEmpty() const {return m_words.empty();}///< Returns true if no mask has been packed.
+
+    int rows() const {return m_rows;}
+    int cols() const {return m_cols;}
+    int wordsPerRow() const {return m_wordsPerRow;}
+
+    /// Returns a pointer to the first word of _row. No control is made.
+    const Word * row(int _row) const {return &m_words[_row * m_wordsPerRow];}
+
+    bool hasSameSize(const PackedMask & _other) const;
+    bool operator==(const PackedMask & _other) const;
+    bool operator!=(const PackedMask & _other) const {return !operator==(_other);}
+
+    quint64 hash() const;
+    int byteSize() const;
+
+    int count() const;
+    int differenceCount(const PackedMask & _other) const;
+    double differenceRatio(const PackedMask & _other) const;
+
+    void swap(PackedMask & _other);
+
+    friend SUBDETECTIONSHARED_EXPORT QDataStream & operator<<(QDataStream & _stream, const PackedMask & _mask);
+    friend SUBDETECTIONSHARED_EXPORT QDataStream & operator>>(QDataStream & _stream, PackedMask & _mask);
+
+protected:
+    int m_rows;
+    int m_cols;
+    int m_wordsPerRow;
+
+    std::vector<Word> m_words;
+};//PackedMask
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_PACKEDMASK_H
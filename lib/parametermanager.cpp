@@ -34,6 +34,7 @@ const QString SETTING_GROUP_MIN = "min";
 const QString SETTING_GROUP_MAX = "max";
 const QString SETTING_GROUP_ZONE = "zone";
 const QString SETTING_GROUP_CHAR_MAX_SIZE = "char_max_size";
+const QString SETTING_GROUP_CHAR_MIN_SIZE = "char_min_size";
 const QString SETTING_GROUP_EDGE_DETECTION = "edge_detection";
 const QString SETTING_GROUP_TOLERANCE = "tolerance";
 const QString SETTING_GROUP_SIMILARITY_DETECTION = "similarity_dectection";
@@ -45,6 +46,7 @@ const QString SETTING_X = "x";
 const QString SETTING_Y = "y";
 const QString SETTING_WIDTH = "width";
 const QString SETTING_HEIGHT = "height";
+const QString SETTING_AREA = "area";
 const QString SETTING_THRESH = "thresh";
 const QString SETTING_MATCH_RATIO = "match_ratio";
 
@@ -190,6 +192,33 @@ void ParameterManager::setCharMaxHeight(int _height)
 
 //-------------------------
 
+void ParameterManager::setCharMinWidth(int _width)
+{
+    m_pParams->charMinSize.width = _width;
+
+    changeNotification();
+}//setCharMinWidth
+
+//-------------------------
+
+void ParameterManager::setCharMinHeight(int _height)
+{
+    m_pParams->charMinSize.height = _height;
+
+    changeNotification();
+}//setCharMinHeight
+
+//-------------------------
+
+void ParameterManager::setCharMinArea(int _area)
+{
+    m_pParams->charMinArea = _area;
+
+    changeNotification();
+}//setCharMinArea
+
+//-------------------------
+
 void ParameterManager::setThresh(int _thresh)
 {
     m_pParams->thresh = _thresh;
@@ -272,6 +301,13 @@ bool ParameterManager::loadSettings(const QString & _filename)
         setCharMaxHeight(settings.value(SETTING_HEIGHT,0).toInt());
     }settings.endGroup();//Char max size
 
+    settings.beginGroup(SETTING_GROUP_CHAR_MIN_SIZE);
+    {
+        setCharMinWidth(settings.value(SETTING_WIDTH,0).toInt());
+        setCharMinHeight(settings.value(SETTING_HEIGHT,0).toInt());
+        setCharMinArea(settings.value(SETTING_AREA,0).toInt());
+    }settings.endGroup();//Char min size
+
     settings.beginGroup(SETTING_GROUP_EDGE_DETECTION);
     {
         setThresh(settings.value(SETTING_THRESH,0).toInt());
@@ -331,6 +367,13 @@ void ParameterManager::saveSettings(const QString & _filename)
         settings.setValue(SETTING_HEIGHT,m_pParams->charMaxSize.height);
     }settings.endGroup();//Char max size
 
+    settings.beginGroup(SETTING_GROUP_CHAR_MIN_SIZE);
+    {
+        settings.setValue(SETTING_WIDTH,m_pParams->charMinSize.width);
+        settings.setValue(SETTING_HEIGHT,m_pParams->charMinSize.height);
+        settings.setValue(SETTING_AREA,m_pParams->charMinArea);
+    }settings.endGroup();//Char min size
+
     settings.beginGroup(SETTING_GROUP_EDGE_DETECTION);
     {
         settings.setValue(SETTING_THRESH,m_pParams->thresh);
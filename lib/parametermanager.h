@@ -70,6 +70,11 @@ public slots:
     void setCharMaxWidth(int _width);
     void setCharMaxHeight(int _height);
 
+    //Noise limits
+    void setCharMinWidth(int _width);
+    void setCharMinHeight(int _height);
+    void setCharMinArea(int _area);
+
     //Edge detection thresh
     void setThresh(int _thresh);
 
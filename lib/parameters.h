@@ -34,6 +34,8 @@ struct SUBDETECTIONSHARED_EXPORT Parameters
 {
     Parameters():zone(0,0,1,1),
                  charMaxSize(5,5),
+                 charMinSize(0,0),
+                 charMinArea(0),
                  thresh(85),
                  xTolerance(1),
                  yTolerance(0),
@@ -45,6 +47,8 @@ struct SUBDETECTIONSHARED_EXPORT Parameters
     Rect zone;///< Subtitle zone.
 
     Size charMaxSize;
+    Size charMinSize;///< Narrower or shorter shapes are dropped as noise when extracted. 0 to disable.
+    int charMinArea;///< Shapes with a smaller area are dropped as noise when extracted. 0 to disable.
 
     Thresh thresh;///< Edge detection thresh
 
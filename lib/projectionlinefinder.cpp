@@ -0,0 +1,248 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <opencv2/core/core.hpp>
+
+#include "deepdebug.h"
+
+#include "projectionlinefinder.h"
+
+namespace SubDetection
+{
+
+ProjectionLineFinder::ProjectionLineFinder():
+    m_charMaxSize(5,5),
+    m_minSize(0,0),
+    m_minArea(0),
+    m_xTolerance(1),
+    m_yTolerance(0)
+{
+}//ProjectionLineFinder
+
+//-------------------------
+
+/*!
+ * \brief ProjectionLineFinder::setCharMaxSize A band taller than a character is ambiguous (touching lines, big shapes).
+ */
+void ProjectionLineFinder::setCharMaxSize(const Size & _charMaxSize)
+{
+    m_charMaxSize = _charMaxSize;
+}//setCharMaxSize
+
+//-------------------------
+
+/*!
+ * \brief ProjectionLineFinder::setNoiseLimits Column groups narrower or shorter than _minSize, or with fewer than _minArea
+ *        pixels, are ignored, as the contour path drops such shapes. See ContourManager::setNoiseLimits.
+ */
+void ProjectionLineFinder::setNoiseLimits(const Size & _minSize, int _minArea)
+{
+    m_minSize = _minSize;
+    m_minArea = _minArea;
+}//setNoiseLimits
+
+//-------------------------
+
+/*!
+ * \brief ProjectionLineFinder::setTolerances See Parameters xTolerance and yTolerance. Empty row runs not longer than
+ *        _yTolerance do not split a band. As in TextLineGrouper, characters whose centers are more than _xTolerance
+ *        apart are not on the same line.
+ */
+void ProjectionLineFinder::setTolerances(Point::value_type _xTolerance, Point::value_type _yTolerance)
+{
+    m_xTolerance = _xTolerance;
+    m_yTolerance = _yTolerance;
+}//setTolerances
+
+//-------------------------
+
+/*!
+ * \brief ProjectionLineFinder::find Finds text lines of _mask, top to bottom.
+ * \param _mask Input CV_8UC1 mask. May be a ROI.
+ * \param _rects Output line rects, in _mask coordinates. Only valid if true is returned.
+ * \return false if result is ambiguous: some set pixels do not belong to a clean single line band.
+ */
+bool ProjectionLineFinder::find(const Mat & _mask, RectVector & _rects)
+{
+    _rects.clear();
+
+    if (_mask.empty()) return true;
+
+    //Row sums: 255 per set pixel
+    cv::reduce(_mask,m_rowSums,1,CV_REDUCE_SUM,CV_32S);
+
+    int rowCount = _mask.rows;
+    int row = 0;
+
+    while (row < rowCount)
+    {
+        //Band start
+        while (row < rowCount && !m_rowSums.at<int>(row,0)) ++row;
+
+        if (row == rowCount) break;
+
+        int firstRow = row;
+        int lastRow = row;
+
+        //Band end: short empty row runs are part of the band (accents, dots)
+        for (int emptyRows = 0; row < rowCount && emptyRows <= m_yTolerance; ++row)
+        {
+            if (m_rowSums.at<int>(row,0))
+            {
+                lastRow = row;
+                emptyRows = 0;
+            }//if (m_rowSums.at<int>(row,0))
+            else
+                ++emptyRows;
+        }//for (int emptyRows = 0; row < rowCount && emptyRows <= m_yTolerance; ++row)
+
+        row = lastRow + 1;
+
+        int bandHeight = lastRow - firstRow + 1;
+
+        if (bandHeight > m_charMaxSize.height || bandHeight < (m_yTolerance / 10))
+        {
+            deepDebug2("ProjectionLineFinder::find : ambiguous band height %d.",bandHeight);
+            return false;
+        }//if (bandHeight > m_charMaxSize.height || bandHeight < (m_yTolerance / 10))
+
+        Rect line;
+
+        if (!findExtent(_mask,firstRow,lastRow,line)) return false;
+
+        _rects.push_back(line);
+    }//while (row < rowCount)
+
+    return true;
+}//find
+
+//-------------------------
+
+/*!
+ * \brief ProjectionLineFinder::findExtent Bounds the band [_firstRow,_lastRow] horizontally. Column groups separated by
+ *        empty columns stand for characters, as shapes do in the contour path. Groups below noise limits are ignored.
+ * \return false if the band is not a single line wide enough to hold text, made of at least three groups no wider
+ *         than a character whose centers are at most xTolerance apart (a bar, touching or spaced shapes must go
+ *         through the contour path).
+ */
+bool ProjectionLineFinder::findExtent(const Mat & _mask, int _firstRow, int _lastRow, Rect & _rect)
+{
+    Mat band = _mask.rowRange(_firstRow,_lastRow + 1);
+
+    cv::reduce(band,m_columnSums,0,CV_REDUCE_SUM,CV_32S);
+
+    const int * pSums = m_columnSums.ptr<int>(0);
+    int columnCount = _mask.cols;
+
+    int firstColumn = 0;
+    int lastColumn = 0;
+    int lastCenter = 0;
+    int groupCount = 0;
+
+    int column = 0;
+
+    while (column < columnCount)
+    {
+        //Group start
+        while (column < columnCount && !pSums[column]) ++column;
+
+        if (column == columnCount) break;
+
+        int groupStart = column;
+        int pixelCount = 0;
+
+        //Group end
+        while (column < columnCount && pSums[column])
+        {
+            pixelCount += pSums[column] / 255;
+            ++column;
+        }//while (column < columnCount && pSums[column])
+
+        int groupWidth = column - groupStart;
+
+        if (groupWidth > m_charMaxSize.width)
+        {
+            deepDebug2("ProjectionLineFinder::findExtent : group wider than a character in band [%d,%d].",_firstRow,_lastRow);
+            return false;
+        }//if (groupWidth > m_charMaxSize.width)
+
+        if (isNoise(band.colRange(groupStart,column),pixelCount)) continue;
+
+        int center = groupStart + (groupWidth - 1) / 2;
+
+        //Too far from previous character to be on the same line
+        if (groupCount && center - lastCenter > m_xTolerance)
+        {
+            deepDebug2("ProjectionLineFinder::findExtent : spaced groups in band [%d,%d].",_firstRow,_lastRow);
+            return false;
+        }//if (groupCount && center - lastCenter > m_xTolerance)
+
+        if (!groupCount) firstColumn = groupStart;
+
+        lastColumn = column - 1;
+        lastCenter = center;
+        ++groupCount;
+    }//while (column < columnCount)
+
+    //Same minimum character count as contour path lines
+    if (groupCount < 3)
+    {
+        deepDebug2("ProjectionLineFinder::findExtent : %d group(s) in band [%d,%d].",groupCount,_firstRow,_lastRow);
+        return false;
+    }//if (groupCount < 3)
+
+    _rect = Rect(firstColumn,_firstRow,lastColumn - firstColumn + 1,_lastRow - _firstRow + 1);
+
+    //Same minimum width as contour path lines
+    if (_rect.width <= m_xTolerance * 3)
+    {
+        deepDebug2("ProjectionLineFinder::findExtent : band [%d,%d] too narrow.",_firstRow,_lastRow);
+        return false;
+    }//if (_rect.width <= m_xTolerance * 3)
+
+    return true;
+}//findExtent
+
+//-------------------------
+
+/*!
+ * \brief ProjectionLineFinder::isNoise Returns true if the column group _group of a band is below noise limits.
+ * \param _pixelCount Set pixels of _group.
+ */
+bool ProjectionLineFinder::isNoise(const Mat & _group, int _pixelCount)
+{
+    if (_group.cols < m_minSize.width || _pixelCount < m_minArea) return true;
+
+    if (m_minSize.height <= 0) return false;
+
+    //Group height: from its first to its last non empty row
+    cv::reduce(_group,m_groupRowSums,1,CV_REDUCE_SUM,CV_32S);
+
+    int firstRow = 0;
+    while (!m_groupRowSums.at<int>(firstRow,0)) ++firstRow;//Group holds at least one pixel
+
+    int lastRow = _group.rows - 1;
+    while (!m_groupRowSums.at<int>(lastRow,0)) --lastRow;
+
+    return (lastRow - firstRow + 1 < m_minSize.height);
+}//isNoise
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,64 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_PROJECTIONLINEFINDER_H
+#define SUBDETECTION_PROJECTIONLINEFINDER_H
+
+#include "subdetection_global.h"
+
+#include "types.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The ProjectionLineFinder class. Finds horizontal text lines in a binary zone mask from its row and column
+ *        projection profiles, without contour extraction. Rows holding set pixels form bands, each band is then
+ *        bounded horizontally by its column profile. Meant for clean subtitles: when bands do not look like single
+ *        text lines, "find" fails and the caller should use the contour path.
+ */
+class SUBDETECTIONSHARED_EXPORT ProjectionLineFinder
+{
+public:
+    ProjectionLineFinder();
+
+    void setCharMaxSize(const Size & _charMaxSize);
+    void setNoiseLimits(const Size & _minSize, int _minArea);
+    void setTolerances(Point::value_type _xTolerance, Point::value_type _yTolerance);
+
+    bool find(const Mat & _mask, RectVector & _rects);
+
+protected:
+    bool findExtent(const Mat & _mask, int _firstRow, int _lastRow, Rect & _rect);
+    bool isNoise(const Mat & _group, int _pixelCount);
+
+    Size m_charMaxSize;
+    Size m_minSize;
+    int m_minArea;
+    Point::value_type m_xTolerance;
+    Point::value_type m_yTolerance;
+
+    Mat m_rowSums;
+    Mat m_columnSums;
+    Mat m_groupRowSums;
+};//ProjectionLineFinder
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_PROJECTIONLINEFINDER_H
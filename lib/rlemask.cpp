@@ -0,0 +1,194 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "rlemask.h"
+
+namespace SubDetection
+{
+
+RleMask::RleMask():
+    m_rows(0),
+    m_cols(0)
+{
+}//RleMask
+
+//-------------------------
+
+/*!
+ * \brief RleMask::encode Encodes _mask as runs.
+ * \param _mask Input CV_8UC1 mask. Every non null pixel is foreground. May be a ROI.
+ */
+void RleMask::encode(const Mat & _mask)
+{
+    reset(_mask.rows,_mask.cols);
+
+    for (int y = 0; y < _mask.rows; ++y)
+    {
+        const uchar * pPixels = _mask.ptr<uchar>(y);
+
+        int x = 0;
+
+        while (x < _mask.cols)
+        {
+            if (!pPixels[x])
+            {
+                ++x;
+                continue;
+            }//if (!pPixels[x])
+
+            int first = x;
+
+            while (x < _mask.cols && pPixels[x]) ++x;
+
+            appendRun(first,x - first);
+        }//while (x < _mask.cols)
+
+        endRow();
+    }//for (int y = 0; y < _mask.rows; ++y)
+}//encode
+
+//-------------------------
+
+/*!
+ * \brief RleMask::decode Writes runs back into a mask.
+ * \param _mask Output CV_8UC1 mask: 255 for run pixels, 0 otherwise.
+ */
+void RleMask::decode(Mat & _mask) const
+{
+    _mask.create(m_rows,m_cols,CV_8UC1);
+    _mask.setTo(Scalar::all(0));
+
+    for (int y = 0; y < m_rows; ++y)
+    {
+        uchar * pPixels = _mask.ptr<uchar>(y);
+
+        for (int i = m_rowOffsets[y]; i < m_rowOffsets[y + 1]; ++i)
+        {
+            std::fill(pPixels + m_runs[i].x,pPixels + m_runs[i].x + m_runs[i].length,255);
+        }//for (int i = m_rowOffsets[y]; i < m_rowOffsets[y + 1]; ++i)
+    }//for (int y = 0; y < m_rows; ++y)
+}//decode
+
+//-------------------------
+
+/*!
+ * \brief RleMask::decode Writes runs back into the _roi part of a mask only. Pixels out of _roi are left untouched,
+ *        so a few lines can be decoded without writing the whole mask.
+ * \param _mask Output CV_8UC1 mask, already allocated with the size of this mask.
+ * \param _roi Part to decode. Must lie inside the mask. No control is made.
+ */
+void RleMask::decode(Mat & _mask, const Rect & _roi) const
+{
+    int roiEnd = _roi.x + _roi.width;
+
+    for (int y = _roi.y; y < _roi.y + _roi.height; ++y)
+    {
+        uchar * pPixels = _mask.ptr<uchar>(y);
+
+        std::fill(pPixels + _roi.x,pPixels + roiEnd,0);
+
+        for (int i = m_rowOffsets[y]; i < m_rowOffsets[y + 1]; ++i)
+        {
+            int first = std::max(m_runs[i].x,_roi.x);
+            int end = std::min(m_runs[i].x + m_runs[i].length,roiEnd);
+
+            if (first < end) std::fill(pPixels + first,pPixels + end,255);
+        }//for (int i = m_rowOffsets[y]; i < m_rowOffsets[y + 1]; ++i)
+    }//for (int y = _roi.y; y < _roi.y + _roi.height; ++y)
+}//decode Rect
+
+//-------------------------
+
+void RleMask::clear()
+{
+    m_rows = 0;
+    m_cols = 0;
+
+    m_runs.clear();
+    m_rowOffsets.clear();
+}//clear
+
+//-------------------------
+
+/*!
+ * \brief RleMask::reset Starts a new _rows x _cols mask, built with appendRun and endRow. Buffers are kept.
+ */
+void RleMask::reset(int _rows, int _cols)
+{
+    m_rows = _rows;
+    m_cols = _cols;
+
+    m_runs.clear();
+    m_rowOffsets.assign(1,0);
+    m_rowOffsets.reserve(_rows + 1);
+}//reset
+
+//-------------------------
+
+/// Returns the number of foreground pixels.
+int RleMask::count() const
+{
+    int result = 0;
+
+    for (RunVector::size_type i = 0; i < m_runs.size(); ++i)
+    {
+        result += m_runs[i].length;
+    }//for (RunVector::size_type i = 0; i < m_runs.size(); ++i)
+
+    return result;
+}//count
+
+//-------------------------
+
+/// Returns the number of bytes used by runs and row offsets.
+int RleMask::byteSize() const
+{
+    return static_cast<int>(m_runs.size() * sizeof(Run) + m_rowOffsets.size() * sizeof(int));
+}//byteSize
+
+//-------------------------
+
+bool RleMask::operator==(const RleMask & _other) const
+{
+    if (m_rows != _other.m_rows || m_cols != _other.m_cols || m_runs.size() != _other.m_runs.size()) return false;
+
+    for (RunVector::size_type i = 0; i < m_runs.size(); ++i)
+    {
+        if (m_runs[i].x != _other.m_runs[i].x || m_runs[i].length != _other.m_runs[i].length) return false;
+    }//for (RunVector::size_type i = 0; i < m_runs.size(); ++i)
+
+    return (m_rowOffsets == _other.m_rowOffsets);
+}//operator==
+
+//-------------------------
+
+void RleMask::swap(RleMask & _other)
+{
+    std::swap(m_rows,_other.m_rows);
+    std::swap(m_cols,_other.m_cols);
+
+    m_runs.swap(_other.m_runs);
+    m_rowOffsets.swap(_other.m_rowOffsets);
+}//swap
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,100 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_RLEMASK_H
+#define SUBDETECTION_RLEMASK_H
+
+#include <vector>
+
+#include "subdetection_global.h"
+
+#include "types.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The RleMask class. Binary mask stored as horizontal runs of foreground pixels, row after row.
+ *        Memory grows with the number of runs instead of the mask area: 8 bytes per run plus 4 bytes per row.
+ *        Runs of a row are ordered by column and never touch each other.
+ */
+class SUBDETECTIONSHARED_EXPORT RleMask
+{
+public:
+    /// Foreground pixels [x, x + length[ of a row.
+    struct Run
+    {
+        int x;
+        int length;
+    };//Run
+
+    typedef std::vector<Run> RunVector;
+
+    RleMask();
+
+    void encode(const Mat & _mask);
+    void decode(Mat & _mask) const;
+    void decode(Mat & _mask, const Rect & _roi) const;
+    void clear();
+
+    void reset(int _rows, int _cols);
+    /// Appends a run to the row being built. Runs must be appended in column order, without touching each other.
+    void appendRun(int _x, int _length)
+    {
+        Run run;
+        run.x = _x;
+        run.length = _length;
+
+        m_runs.push_back(run);
+    }//appendRun
+    /// Ends the row being built. Must be called once per row, empty rows included.
+    void endRow() {m_rowOffsets.push_back(static_cast<int>(m_runs.size()));}
+
+    bool isEmpty() const {return !m_rows;}///< Returns true if no mask has been encoded.
+
+    int rows() const {return m_rows;}
+    int cols() const {return m_cols;}
+
+    int runCount() const {return static_cast<int>(m_runs.size());}
+    /// Returns the index of the first run of _row. No control is made.
+    int rowOffset(int _row) const {return m_rowOffsets[_row];}
+    /// Returns the number of runs of _row. No control is made.
+    int rowRunCount(int _row) const {return m_rowOffsets[_row + 1] - m_rowOffsets[_row];}
+    /// Returns the runs of the whole mask, row after row.
+    const RunVector & runs() const {return m_runs;}
+
+    int count() const;
+    int byteSize() const;
+
+    bool operator==(const RleMask & _other) const;
+    bool operator!=(const RleMask & _other) const {return !operator==(_other);}
+
+    void swap(RleMask & _other);
+
+protected:
+    int m_rows;
+    int m_cols;
+
+    RunVector m_runs;
+    std::vector<int> m_rowOffsets;///< Index of the first run of each row, plus the total run count.
+};//RleMask
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_RLEMASK_H
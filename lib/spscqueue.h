@@ -0,0 +1,179 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_SPSCQUEUE_H
+#define SUBDETECTION_SPSCQUEUE_H
+
+#include <vector>
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The SpscQueue class. Bounded lock-free queue for one producer thread and one consumer thread.
+ *        Blocking push and pop give backpressure: they spin for a while, then sleep on a wait condition until
+ *        the other side pops or pushes. Non blocking calls only take a lock when the other side is asleep.
+ */
+template<class T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(int _capacity):
+        m_items(qMax(_capacity,1) + 1),//One slot is kept empty to tell full from empty
+        m_head(0),
+        m_tail(0),
+        m_pushWaiting(0),
+        m_popWaiting(0)
+    {
+    }//SpscQueue
+
+    int capacity() const {return static_cast<int>(m_items.size()) - 1;}
+
+    /// Producer only. Returns false if queue is full.
+    bool tryPush(const T & _item)
+    {
+        if (!pushItem(_item)) return false;
+
+        wake(m_popWaiting,m_notEmpty);
+
+        return true;
+    }//tryPush
+
+    /// Consumer only. Returns false if queue is empty.
+    bool tryPop(T & _item)
+    {
+        if (!popItem(_item)) return false;
+
+        wake(m_pushWaiting,m_notFull);
+
+        return true;
+    }//tryPop
+
+    /// Producer only. Waits while queue is full.
+    void push(const T & _item)
+    {
+        for (int attempt = 0; attempt < SPIN_COUNT; ++attempt)
+        {
+            if (tryPush(_item)) return;
+
+            QThread::yieldCurrentThread();
+        }//for (int attempt = 0; attempt < SPIN_COUNT; ++attempt)
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            m_pushWaiting.fetchAndStoreOrdered(1);
+
+            while (!pushItem(_item)) m_notFull.wait(&m_mutex);
+
+            m_pushWaiting.fetchAndStoreOrdered(0);
+        }
+
+        //Consumer may be asleep too, it is woken without holding the lock
+        wake(m_popWaiting,m_notEmpty);
+    }//push
+
+    /// Consumer only. Waits while queue is empty.
+    void pop(T & _item)
+    {
+        for (int attempt = 0; attempt < SPIN_COUNT; ++attempt)
+        {
+            if (tryPop(_item)) return;
+
+            QThread::yieldCurrentThread();
+        }//for (int attempt = 0; attempt < SPIN_COUNT; ++attempt)
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            m_popWaiting.fetchAndStoreOrdered(1);
+
+            while (!popItem(_item)) m_notEmpty.wait(&m_mutex);
+
+            m_popWaiting.fetchAndStoreOrdered(0);
+        }
+
+        wake(m_pushWaiting,m_notFull);
+    }//pop
+
+protected:
+    static const int SPIN_COUNT = 16;///< Attempts before sleeping in push and pop.
+
+    int increment(int _index) const {return (_index + 1 == static_cast<int>(m_items.size())) ? 0 : _index + 1;}
+
+    bool pushItem(const T & _item)
+    {
+        int tail = m_tail.load();
+        int next = increment(tail);
+
+        if (next == m_head.loadAcquire()) return false;
+
+        m_items[tail] = _item;
+        m_tail.fetchAndStoreOrdered(next);
+
+        return true;
+    }//pushItem
+
+    bool popItem(T & _item)
+    {
+        int head = m_head.load();
+
+        if (head == m_tail.loadAcquire()) return false;
+
+        _item = m_items[head];
+        m_items[head] = T();//Releases resources held by the item
+        m_head.fetchAndStoreOrdered(increment(head));
+
+        return true;
+    }//popItem
+
+    /// Wakes the other side if it is asleep. Index and flag are both read-modify-written, so a thread setting
+    /// its flag then checking the queue cannot miss the update made just before this call.
+    void wake(QAtomicInt & _waiting, QWaitCondition & _condition)
+    {
+        if (!_waiting.fetchAndAddOrdered(0)) return;
+
+        QMutexLocker locker(&m_mutex);
+        _condition.wakeOne();
+    }//wake
+
+    std::vector<T> m_items;
+
+    QAtomicInt m_head;///< Next item to pop. Written by consumer.
+    QAtomicInt m_tail;///< Next slot to push. Written by producer.
+
+    QMutex m_mutex;///< Only taken to sleep and to wake.
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    QAtomicInt m_pushWaiting;///< Producer sleeps, or is about to.
+    QAtomicInt m_popWaiting;///< Consumer sleeps, or is about to.
+
+private:
+    Q_DISABLE_COPY(SpscQueue)
+};//SpscQueue
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_SPSCQUEUE_H
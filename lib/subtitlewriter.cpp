@@ -0,0 +1,142 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "deepdebug.h"
+
+#include "subtitlewriter.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+    /// Escapes characters having a meaning in WebVTT cue text.
+    QString escapeWebVtt(const QString & _text)
+    {
+        QString result = _text;
+
+        result.replace('&',"&amp;");
+        result.replace('<',"&lt;");
+        result.replace('>',"&gt;");
+
+        return result;
+    }//escapeWebVtt
+}//namespace
+
+SubtitleWriter::SubtitleWriter(Format _format):
+    m_format(_format),
+    m_eventCount(0)
+{
+}//SubtitleWriter
+
+//-------------------------
+
+SubtitleWriter::~SubtitleWriter()
+{
+    close();
+}//~SubtitleWriter
+
+//-------------------------
+
+/*!
+ * \brief SubtitleWriter::open Creates or truncates _filePath, then writes format header if any.
+ * \return false if file could not be opened.
+ */
+bool SubtitleWriter::open(const QString & _filePath)
+{
+    close();
+
+    m_file.setFileName(_filePath);
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        deepDebug("SubtitleWriter::open : cannot open %s",qPrintable(_filePath));
+        return false;
+    }//if (!m_file.open(...
+
+    m_stream.setDevice(&m_file);
+    m_stream.setCodec("UTF-8");
+
+    m_eventCount = 0;
+
+    if (m_format == SF_WEBVTT)
+    {
+        m_stream << "WEBVTT\n\n";
+        m_stream.flush();
+    }//if (m_format == SF_WEBVTT)
+
+    return true;
+}//open
+
+//-------------------------
+
+void SubtitleWriter::close()
+{
+    if (!m_file.isOpen()) return;
+
+    m_stream.flush();
+    m_stream.setDevice(0);
+
+    m_file.close();
+}//close
+
+//-------------------------
+
+/*!
+ * \brief SubtitleWriter::write Writes _event then flushes the file. Events must be written in chronological order.
+ */
+void SubtitleWriter::write(const SubtitleEvent & _event)
+{
+    if (!m_file.isOpen()) return;
+
+    ++m_eventCount;
+
+    if (m_format == SF_SRT) m_stream << m_eventCount << '\n';
+
+    m_stream << timestamp(_event.startMs,m_format) << " --> " << timestamp(_event.endMs,m_format) << '\n';
+
+    for (int i = 0; i < _event.lines.size(); ++i)
+    {
+        m_stream << (m_format == SF_WEBVTT ? escapeWebVtt(_event.lines[i]) : _event.lines[i]) << '\n';
+    }//for (int i = 0; i < _event.lines.size(); ++i)
+
+    m_stream << '\n';
+    m_stream.flush();
+}//write
+
+//-------------------------
+
+/*!
+ * \brief SubtitleWriter::timestamp Returns _ms formatted as "hh:mm:ss,mmm" (SubRip) or "hh:mm:ss.mmm" (WebVTT).
+ */
+QString SubtitleWriter::timestamp(qint64 _ms, Format _format)
+{
+    if (_ms < 0) _ms = 0;
+
+    return QString("%1:%2:%3%4%5")
+            .arg(_ms / 3600000,2,10,QChar('0'))
+            .arg((_ms / 60000) % 60,2,10,QChar('0'))
+            .arg((_ms / 1000) % 60,2,10,QChar('0'))
+            .arg(_format == SF_SRT ? ',' : '.')
+            .arg(_ms % 1000,3,10,QChar('0'));
+}//timestamp
+
+//-------------------------
+
+}//namespace SubDetection
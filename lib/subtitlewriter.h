@@ -0,0 +1,85 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_SUBTITLEWRITER_H
+#define SUBDETECTION_SUBTITLEWRITER_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include "subdetection_global.h"
+
+namespace SubDetection
+{
+
+/// Subtitle displayed between two timestamps.
+struct SubtitleEvent
+{
+    SubtitleEvent(): startMs(0), endMs(0) {}
+
+    qint64 startMs;///< Display start, in milliseconds.
+    qint64 endMs;///< Display end, in milliseconds.
+    QStringList lines;
+};//SubtitleEvent
+
+/*!
+ * \brief The SubtitleWriter class. Writes subtitle events to a file, flushing after each event so that the file
+ *        can be read while it is being written.
+ */
+class SUBDETECTIONSHARED_EXPORT SubtitleWriter
+{
+public:
+    enum Format
+    {
+        SF_SRT,///< SubRip
+        SF_WEBVTT///< Web Video Text Tracks
+    };//Format
+
+    explicit SubtitleWriter(Format _format);
+    ~SubtitleWriter();
+
+    Format format() const {return m_format;}
+
+    bool open(const QString & _filePath);
+    bool isOpen() const {return m_file.isOpen();}
+    void close();
+
+    void write(const SubtitleEvent & _event);
+
+    int eventCount() const {return m_eventCount;}///< Returns the number of events written since file was opened.
+
+    static QString timestamp(qint64 _ms, Format _format);
+
+protected:
+    Format m_format;
+
+    QFile m_file;
+    QTextStream m_stream;
+
+    int m_eventCount;
+
+private:
+    Q_DISABLE_COPY(SubtitleWriter)
+};//SubtitleWriter
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_SUBTITLEWRITER_H
@@ -0,0 +1,563 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include <QMap>
+
+#include "deepdebug.h"
+
+#include "textlinegrouper.h"
+
+namespace SubDetection
+{
+
+namespace
+{
+    const Point::value_type UNDEFINED_COORD = -1;
+
+    typedef QMap<Point::value_type,quint32> CoordCountMap;
+
+    /// Orders point indexes along X axis, then Y axis, then index.
+    class PointIndexCompare
+    {
+    public:
+        PointIndexCompare(const PointVector & _points): m_points(_points) {}
+
+        bool operator()(int _first, int _second) const
+        {
+            const Point & first = m_points[_first];
+            const Point & second = m_points[_second];
+
+            if (first.x != second.x) return (first.x < second.x);
+            if (first.y != second.y) return (first.y < second.y);
+
+            return (_first < _second);
+        }//operator()
+
+    protected:
+        const PointVector & m_points;
+    };//PointIndexCompare
+//------
+    /*!
+     * \brief The MaxTree class. Segment tree of integers supporting range add and global maximum.
+     *        The leftmost position holding the maximum is returned.
+     */
+    class MaxTree
+    {
+    public:
+        void build(const std::vector<int> & _values)
+        {
+            m_size = static_cast<int>(_values.size());
+            m_max.assign(4 * m_size,0);
+            m_lazy.assign(4 * m_size,0);
+            m_index.assign(4 * m_size,0);
+
+            if (m_size) build(1,0,m_size - 1,_values);
+        }//build
+
+        void add(int _first, int _last, int _value) {add(1,0,m_size - 1,_first,_last,_value);}
+
+        int max() const {return m_max[1];}
+        int maxIndex() const {return m_index[1];}
+
+    protected:
+        void build(int _node, int _begin, int _end, const std::vector<int> & _values)
+        {
+            if (_begin == _end)
+            {
+                m_max[_node] = _values[_begin];
+                m_index[_node] = _begin;
+                return;
+            }//if (_begin == _end)
+
+            int middle = (_begin + _end) / 2;
+            build(2 * _node,_begin,middle,_values);
+            build(2 * _node + 1,middle + 1,_end,_values);
+            pull(_node);
+        }//build
+
+        void add(int _node, int _begin, int _end, int _first, int _last, int _value)
+        {
+            if (_last < _begin || _end < _first) return;
+
+            if (_first <= _begin && _end <= _last)
+            {
+                m_max[_node] += _value;
+                m_lazy[_node] += _value;
+                return;
+            }//if (_first <= _begin && _end <= _last)
+
+            int middle = (_begin + _end) / 2;
+            add(2 * _node,_begin,middle,_first,_last,_value);
+            add(2 * _node + 1,middle + 1,_end,_first,_last,_value);
+            pull(_node);
+        }//add
+
+        /// Pending additions stay in the node they were applied to.
+        void pull(int _node)
+        {
+            int left = 2 * _node;
+            int right = left + 1;
+            int child = (m_max[left] >= m_max[right]) ? left : right;
+
+            m_max[_node] = m_max[child] + m_lazy[_node];
+            m_index[_node] = m_index[child];
+        }//pull
+
+        int m_size;
+        std::vector<int> m_max;
+        std::vector<int> m_lazy;
+        std::vector<int> m_index;
+    };//MaxTree
+//------
+    /*!
+     * \brief The MinTree class. Segment tree of integers supporting point update and range minimum.
+     *        The leftmost position holding the minimum is returned.
+     */
+    class MinTree
+    {
+    public:
+        void build(const std::vector<int> & _values)
+        {
+            m_size = 1;
+            while (m_size < static_cast<int>(_values.size())) m_size *= 2;
+
+            m_values.assign(2 * m_size,std::numeric_limits<int>::max());
+            m_index.assign(2 * m_size,0);
+
+            for (int i = 0; i < m_size; ++i)
+            {
+                if (i < static_cast<int>(_values.size())) m_values[m_size + i] = _values[i];
+                m_index[m_size + i] = i;
+            }//for (int i = 0; i < m_size; ++i)
+
+            for (int node = m_size - 1; node > 0; --node)
+            {
+                pull(node);
+            }//for (int node = m_size - 1; node > 0; --node)
+        }//build
+
+        void set(int _position, int _value)
+        {
+            int node = m_size + _position;
+            m_values[node] = _value;
+
+            for (node /= 2; node > 0; node /= 2)
+            {
+                pull(node);
+            }//for (node /= 2; node > 0; node /= 2)
+        }//set
+
+        /// Returns the leftmost position of the minimum in [_first,_last].
+        int minIndex(int _first, int _last) const {return minIndex(1,0,m_size - 1,_first,_last);}
+
+        int value(int _position) const {return m_values[m_size + _position];}
+
+    protected:
+        int minIndex(int _node, int _begin, int _end, int _first, int _last) const
+        {
+            if (_first <= _begin && _end <= _last) return m_index[_node];
+
+            int middle = (_begin + _end) / 2;
+
+            if (_last <= middle) return minIndex(2 * _node,_begin,middle,_first,_last);
+            if (_first > middle) return minIndex(2 * _node + 1,middle + 1,_end,_first,_last);
+
+            int left = minIndex(2 * _node,_begin,middle,_first,_last);
+            int right = minIndex(2 * _node + 1,middle + 1,_end,_first,_last);
+
+            return (value(left) <= value(right)) ? left : right;
+        }//minIndex
+
+        void pull(int _node)
+        {
+            int left = 2 * _node;
+            int child = (m_values[left] <= m_values[left + 1]) ? left : left + 1;
+
+            m_values[_node] = m_values[child];
+            m_index[_node] = m_index[child];
+        }//pull
+
+        int m_size;
+        std::vector<int> m_values;
+        std::vector<int> m_index;
+    };//MinTree
+}//namespace
+
+//-------------------------
+
+TextLineGrouper::TextLineGrouper(Method _method):
+    m_method(_method),
+    m_xTolerance(1),
+    m_yTolerance(0)
+{
+}//TextLineGrouper
+
+//-------------------------
+
+void TextLineGrouper::setMethod(Method _method)
+{
+    m_method = _method;
+}//setMethod
+
+//-------------------------
+
+/*!
+ * \brief TextLineGrouper::setTolerances See Parameters xTolerance and yTolerance.
+ */
+void TextLineGrouper::setTolerances(Point::value_type _xTolerance, Point::value_type _yTolerance)
+{
+    m_xTolerance = _xTolerance;
+    m_yTolerance = _yTolerance;
+}//setTolerances
+
+//-------------------------
+
+/*!
+ * \brief TextLineGrouper::group Groups component mass centers into lines.
+ * \param _components Input components. Mass center coordinates must not be negative.
+ * \param _lines Output lines, in the order they were found.
+ */
+void TextLineGrouper::group(const ComponentTable & _components, LineVector & _lines) const
+{
+    _lines.clear();
+
+    if (_components.isEmpty()) return;
+
+    if (m_method == GM_LEGACY)
+        groupLegacy(_components,_lines);
+    else
+        groupSorted(_components,_lines);
+}//group
+
+//-------------------------
+
+void TextLineGrouper::groupLegacy(const ComponentTable & _components, LineVector & _lines) const
+{
+    const PointVector & massCenters = _components.massCenters;
+
+    //Component indexes, sorted by X
+    std::vector<int> validMassCenters(_components.size());
+    for (int i = 0; i < _components.size(); ++i) validMassCenters[i] = i;
+
+    std::sort(validMassCenters.begin(),validMassCenters.end(),PointIndexCompare(massCenters));
+
+    //While there are points to deal with
+    do
+    {
+        CoordCountMap alignmentCountMap;
+
+        deepDebug3("Point list:");
+        //Building a count map for each different Y coordinate
+        for (std::vector<int>::iterator it = validMassCenters.begin(); it != validMassCenters.end(); ++it)
+        {
+            Point::value_type y = massCenters[*it].y;
+
+            deepDebug3("%d:%d",massCenters[*it].x,y);
+
+            int alignmentCount = alignmentCountMap.value(y,0) +1;
+            alignmentCountMap.insert(y,alignmentCount);
+        }//for (std::vector<int>::iterator it = validMassCenters.begin(); it != validMassCenters.end(); ++it)
+
+        int maxCount = 0;
+
+        CoordCountMap::const_iterator firstItem;
+        CoordCountMap::const_iterator lastItem;
+
+        bool stop;
+
+        deepDebug3("Searching best alignment...");
+        //Searching the biggest group of aligned points
+        for (CoordCountMap::const_iterator i = alignmentCountMap.begin(); i != alignmentCountMap.end(); ++i)
+        {
+            stop = false;
+
+            Point::value_type refY = i.key();
+            int count = *i;
+
+            if (count > maxCount)
+            {
+                maxCount = count;
+
+                firstItem = i;
+                lastItem = i;
+            }//if (count > maxCount)
+
+            for (CoordCountMap::const_iterator j = i+1; j != alignmentCountMap.end() && !stop; ++j)
+            {
+                //If points with this Y coordinate are not in tolerance zone
+                if ((j.key() - refY) > m_yTolerance)
+                {
+                    stop = true;
+                }//if ((j.key() - refY) > m_yTolerance)
+                else
+                {
+                    count += *j;
+                    if (count > maxCount)
+                    {
+                        maxCount = count;
+
+                        firstItem = i;
+                        lastItem = j;
+                    }//if (count > maxCount)
+                }//if ((j.key() - refY) > m_yTolerance)...else
+            }//for (CoordCountMap::const_iterator j = i+1; j != alignmentCountMap.end() && !stop; ++j)
+        }//for (CoordCountMap::const_iterator i = alignmentCountMap.begin(); i != alignmentCountMap.end(); ++i)
+
+        //Only one point?
+        if (maxCount == 1)
+        {
+            //No need to keep it, removing first (and only one)
+            for (std::vector<int>::iterator it = validMassCenters.begin(); it != validMassCenters.end(); ++it)
+            {
+                if (massCenters[*it].y == firstItem.key())
+                {
+                    validMassCenters.erase(it);
+                    break;
+                }//if (massCenters[*it].y == firstItem.key())
+            }//for (std::vector<int>::iterator it = validMassCenters.begin(); it != validMassCenters.end(); ++it)
+        }//if (maxCount == 1)
+        else
+        {
+            Point::value_type lastX = UNDEFINED_COORD;
+            Point::value_type currentX;
+            bool validPoint;
+            stop = false;
+
+            Rect::value_type minX = std::numeric_limits<Rect::value_type>::max();
+            Rect::value_type minY = std::numeric_limits<Rect::value_type>::max();
+            Rect::value_type maxX = 0;
+            Rect::value_type maxY = 0;
+
+            Line line;
+
+            //Building result
+            for (std::vector<int>::iterator it = validMassCenters.begin(); it != validMassCenters.end() && !stop;)
+            {
+                validPoint = false;
+                currentX = massCenters[*it].x;//Saving X coordinate for spacing check
+
+                //Checking if point is in alignment range
+                if (massCenters[*it].y >= firstItem.key() && massCenters[*it].y <= lastItem.key())
+                {
+                    //First point of this group?
+                    if (lastX == UNDEFINED_COORD)
+                    {
+                        validPoint = true;
+                    }//if (lastX == UNDEFINED_COORD)
+                    else
+                    {
+                        //Is spacing correct?
+                        if ((currentX - lastX) <= m_xTolerance)
+                        {
+                            validPoint = true;
+                        }//if ((currentX - lastX) <= m_xTolerance)
+                        else
+                        {
+                            //If this point is too far from the last one, the next ones will be too
+                            stop = true;
+                        }//if ((currentX - lastX) <= m_xTolerance)...else
+                    }//if (lastX == UNDEFINED_COORD)...else
+                }//if (massCenters[*it].y >= firstItem.key() && massCenters[*it].y <= lastItem.key())
+
+                //Point is OK
+                if (validPoint)
+                {
+                    const Rect & tmpRect = _components.boundings[*it];
+                    //Saving extrema
+                    if (tmpRect.tl().x < minX) minX = tmpRect.tl().x;
+                    if (tmpRect.tl().y < minY) minY = tmpRect.tl().y;
+                    if (tmpRect.br().x > maxX) maxX = tmpRect.br().x;
+                    if (tmpRect.br().y > maxY) maxY = tmpRect.br().y;
+
+                    //Saving X coordinate to check spacing
+                    lastX = currentX;
+
+                    line.indexes.push_back(_components.indexes[*it]);
+
+                    //Removing it from the list
+                    it = validMassCenters.erase(it);
+                }//if (validPoint)
+                else
+                    ++it;
+            }//for (std::vector<int>::iterator it = validMassCenters.begin(); it != validMassCenters.end() && !stop;)
+
+            line.rect = Rect(minX,minY,maxX - minX,maxY - minY);
+            line.count = maxCount;
+
+            _lines.push_back(line);
+        }//if (maxCount == 1)...else
+    } while (!validMassCenters.empty());
+}//groupLegacy
+
+//-------------------------
+
+/*!
+ * \brief TextLineGrouper::groupSorted Same result as groupLegacy.
+ *        Distinct Y values are sorted once. For each one, the number of remaining points in its Y window is kept in a
+ *        segment tree updated when a point is taken, so the best window is read at the root. Points of each Y value are
+ *        sorted along X and always taken from the left, so a head index per Y value is enough: a second segment tree
+ *        gives the leftmost head in a Y window.
+ */
+void TextLineGrouper::groupSorted(const ComponentTable & _components, LineVector & _lines) const
+{
+    const PointVector & massCenters = _components.massCenters;
+
+    int pointCount = _components.size();
+
+    //Points along X axis
+    std::vector<int> order(pointCount);
+    for (int i = 0; i < pointCount; ++i) order[i] = i;
+
+    std::sort(order.begin(),order.end(),PointIndexCompare(massCenters));
+
+    //Distinct Y values
+    std::vector<int> ys(pointCount);
+    for (int i = 0; i < pointCount; ++i) ys[i] = massCenters[i].y;
+
+    std::sort(ys.begin(),ys.end());
+    ys.erase(std::unique(ys.begin(),ys.end()),ys.end());
+
+    int keyCount = static_cast<int>(ys.size());
+
+    //Points of each Y value along X axis, stored one key after the other
+    std::vector<int> keys(pointCount);
+    std::vector<int> counts(keyCount,0);
+
+    for (int i = 0; i < pointCount; ++i)
+    {
+        keys[i] = static_cast<int>(std::lower_bound(ys.begin(),ys.end(),massCenters[order[i]].y) - ys.begin());
+        ++counts[keys[i]];
+    }//for (int i = 0; i < pointCount; ++i)
+
+    std::vector<int> heads(keyCount + 1,0);
+    for (int key = 0; key < keyCount; ++key) heads[key + 1] = heads[key] + counts[key];
+
+    std::vector<int> keyPoints(pointCount);
+    {
+        std::vector<int> positions(heads.begin(),heads.end() - 1);
+
+        for (int i = 0; i < pointCount; ++i) keyPoints[positions[keys[i]]++] = i;
+    }
+
+    //Y windows: [key, windowEnds[key]] are the keys within yTolerance above key, windowStarts[key] the first key reaching it
+    std::vector<int> windowStarts(keyCount);
+    std::vector<int> windowEnds(keyCount);
+    std::vector<int> windowCounts(keyCount);
+
+    for (int key = 0, end = 0, start = 0; key < keyCount; ++key)
+    {
+        while (end + 1 < keyCount && ys[end + 1] - ys[key] <= m_yTolerance) ++end;
+        while (ys[key] - ys[start] > m_yTolerance) ++start;
+
+        windowEnds[key] = end;
+        windowStarts[key] = start;
+        windowCounts[key] = heads[end + 1] - heads[key];
+    }//for (int key = 0, end = 0, start = 0; key < keyCount; ++key)
+
+    MaxTree windowTree;
+    windowTree.build(windowCounts);
+
+    std::vector<int> headXs(keyCount);
+    for (int key = 0; key < keyCount; ++key) headXs[key] = massCenters[order[keyPoints[heads[key]]]].x;
+
+    MinTree headTree;
+    headTree.build(headXs);
+
+    //Subtracted from an emptied key so that it is never selected again
+    const int EMPTY_KEY = -2 * (pointCount + 1);
+
+    int remaining = pointCount;
+
+    while (remaining)
+    {
+        int firstKey = windowTree.maxIndex();
+        int maxCount = windowTree.max();
+
+        //Only one point? It is dropped.
+        int lastKey = (maxCount == 1) ? firstKey : windowEnds[firstKey];
+
+        Rect::value_type minX = std::numeric_limits<Rect::value_type>::max();
+        Rect::value_type minY = std::numeric_limits<Rect::value_type>::max();
+        Rect::value_type maxX = 0;
+        Rect::value_type maxY = 0;
+
+        Point::value_type lastX = 0;
+        bool first = true;
+
+        Line line;
+
+        do
+        {
+            //Leftmost remaining point of the window
+            int key = headTree.minIndex(firstKey,lastKey);
+
+            if (!counts[key]) break;
+
+            int point = keyPoints[heads[key]];
+            Point::value_type currentX = massCenters[order[point]].x;
+
+            //If this point is too far from the last one, the next ones will be too
+            if (!first && (currentX - lastX) > m_xTolerance) break;
+
+            const Rect & tmpRect = _components.boundings[order[point]];
+            //Saving extrema
+            if (tmpRect.tl().x < minX) minX = tmpRect.tl().x;
+            if (tmpRect.tl().y < minY) minY = tmpRect.tl().y;
+            if (tmpRect.br().x > maxX) maxX = tmpRect.br().x;
+            if (tmpRect.br().y > maxY) maxY = tmpRect.br().y;
+
+            lastX = currentX;
+            first = false;
+
+            if (maxCount > 1) line.indexes.push_back(_components.indexes[order[point]]);
+
+            //Removing it
+            ++heads[key];
+            --counts[key];
+            --remaining;
+
+            windowTree.add(windowStarts[key],key,-1);
+
+            if (counts[key])
+            {
+                headTree.set(key,massCenters[order[keyPoints[heads[key]]]].x);
+            }//if (counts[key])
+            else
+            {
+                windowTree.add(key,key,EMPTY_KEY);
+                headTree.set(key,std::numeric_limits<int>::max());
+            }//if (counts[key])...else
+        } while (maxCount > 1);
+
+        if (maxCount > 1)
+        {
+            line.rect = Rect(minX,minY,maxX - minX,maxY - minY);
+            line.count = maxCount;
+
+            _lines.push_back(line);
+        }//if (maxCount > 1)
+    }//while (remaining)
+}//groupSorted
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,80 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_TEXTLINEGROUPER_H
+#define SUBDETECTION_TEXTLINEGROUPER_H
+
+#include <vector>
+
+#include "subdetection_global.h"
+
+#include "types.h"
+#include "componenttable.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The TextLineGrouper class. Groups character mass centers into text lines.
+ *        While points remain, the Y window of yTolerance height holding the most points is selected, then its points
+ *        are taken along X axis, from the leftmost one, until two of them are more than xTolerance apart.
+ *        A group of a single point is dropped. Validity of a line (character count, size) is left to the caller.
+ */
+class SUBDETECTIONSHARED_EXPORT TextLineGrouper
+{
+public:
+    /// Grouping implementation. Both give the same lines, in the same order, from mass centers with no negative coordinate.
+    enum Method
+    {
+        GM_LEGACY,///< Y count map rebuilt and point list scanned on every line. Quadratic.
+        GM_SORTED///< Sorted arrays and segment trees updated as points are taken. O(n log n) (default)
+    };//Method
+
+    /// Group of aligned points.
+    struct Line
+    {
+        Rect rect;///< Union of the bounding rects of taken points.
+        int count;///< Number of points in the selected Y window. May be greater than taken points.
+        IndexVector indexes;///< ContourManager shape indexes of taken points (ComponentTable::indexes values), along X axis.
+    };//Line
+
+    typedef std::vector<Line> LineVector;
+
+    TextLineGrouper(Method _method = GM_SORTED);
+
+    void setMethod(Method _method);
+    Method method() const {return m_method;}
+
+    void setTolerances(Point::value_type _xTolerance, Point::value_type _yTolerance);
+
+    void group(const ComponentTable & _components, LineVector & _lines) const;
+
+protected:
+    void groupLegacy(const ComponentTable & _components, LineVector & _lines) const;
+    void groupSorted(const ComponentTable & _components, LineVector & _lines) const;
+
+    Method m_method;
+
+    Point::value_type m_xTolerance;
+    Point::value_type m_yTolerance;
+};//TextLineGrouper
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_TEXTLINEGROUPER_H
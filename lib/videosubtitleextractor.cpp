@@ -0,0 +1,418 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QStringList>
+
+#include "deepdebug.h"
+
+#include "videosubtitleextractor.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief VideoSubtitleExtractor::Statistics::fps Returns the number of frames processed per second.
+ */
+double VideoSubtitleExtractor::Statistics::fps() const
+{
+    if (!elapsedMs) return 0.;
+
+    return 1000. * frameCount / elapsedMs;
+}//fps
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::Statistics::realtimeFactor Returns video duration divided by processing time.
+ *        Greater than 1 when processing is faster than playback.
+ */
+double VideoSubtitleExtractor::Statistics::realtimeFactor() const
+{
+    if (!elapsedMs) return 0.;
+
+    return static_cast<double>(videoMs) / elapsedMs;
+}//realtimeFactor
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::VideoSubtitleExtractor
+ * \param _detector Detector with parameters set. It must outlive the extractor.
+ */
+VideoSubtitleExtractor::VideoSubtitleExtractor(Detector & _detector):
+    m_detector(_detector),
+    m_fps(0.),
+    m_frameIndex(0),
+    m_lastTimestamp(0),
+    m_adaptiveSampling(false),
+    m_minDurationMs(DEFAULT_MIN_DURATION_MS),
+    m_probeInterval(1),
+    m_eventPending(false)
+{
+}//VideoSubtitleExtractor
+
+//-------------------------
+
+VideoSubtitleExtractor::~VideoSubtitleExtractor()
+{
+    close();
+}//~VideoSubtitleExtractor
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::open Opens _videoPath. Detector is told to forget previous detection.
+ * \return false if video could not be opened.
+ */
+bool VideoSubtitleExtractor::open(const QString & _videoPath)
+{
+    close();
+
+    if (!m_capture.open(_videoPath.toLocal8Bit().constData()))
+    {
+        deepDebug("VideoSubtitleExtractor::open : cannot open %s",qPrintable(_videoPath));
+        return false;
+    }//if (!m_capture.open(...
+
+    m_fps = m_capture.get(CV_CAP_PROP_FPS);
+    m_frameIndex = 0;
+    m_lastTimestamp = 0;
+    m_eventPending = false;
+    m_statistics = Statistics();
+
+    m_buffer.clear();
+    m_referenceBits.clear();
+    enableAdaptiveSampling(m_adaptiveSampling,m_minDurationMs);//Probe interval depends on frame rate
+
+    m_detector.forget();
+
+    m_timer.start();
+
+    return true;
+}//open
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::close Ends current event, if any, at the end of the last frame. Then closes the video.
+ *        Writers stay open.
+ */
+void VideoSubtitleExtractor::close()
+{
+    if (!m_capture.isOpened()) return;
+
+    //Frames read since last probe
+    if (m_buffer.size() > 1) probeBuffer();
+
+    m_buffer.clear();
+
+    //Last frame is displayed during one frame duration
+    qint64 endTimestamp = m_lastTimestamp + (m_fps > 0. ? qRound64(1000. / m_fps) : 0);
+
+    endEvent(endTimestamp);
+
+    m_statistics.videoMs = endTimestamp;
+    m_statistics.elapsedMs = m_timer.elapsed();
+
+    m_capture.release();
+}//close
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::addWriter Adds a writer receiving every event ending from now on.
+ *        Writer must be opened by the caller.
+ */
+void VideoSubtitleExtractor::addWriter(const SubtitleWriterPtr & _pWriter)
+{
+    if (_pWriter) m_writers.append(_pWriter);
+}//addWriter
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::enableAdaptiveSampling Enable or disable adaptive sampling. When enabled, only text
+ *        zones are kept from frames and only one frame every _minDurationMs goes through HSV masking. When a probe
+ *        differs from previous state, frames in between are bisected to find the exact frame where text changed,
+ *        which is the only one sent to Detector. Text shown less than _minDurationMs may be missed.
+ *        Detection is then the same as with Detector zone processing.
+ * \param _enabled true: enable, false: disable (default).
+ * \param _minDurationMs Minimum subtitle display duration, in milliseconds.
+ */
+void VideoSubtitleExtractor::enableAdaptiveSampling(bool _enabled, int _minDurationMs)
+{
+    m_adaptiveSampling = _enabled;
+    m_minDurationMs = qMax(_minDurationMs,0);
+
+    //Without frame rate, every frame is probed
+    m_probeInterval = (m_fps > 0.) ? qMax(static_cast<int>(m_minDurationMs * m_fps / 1000.),1) : 1;
+}//enableAdaptiveSampling
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::processNextFrame Reads and processes the next frame.
+ * \return false if there is no more frame. Video is then closed.
+ */
+bool VideoSubtitleExtractor::processNextFrame()
+{
+    if (!m_capture.isOpened()) return false;
+
+    if (!m_capture.read(m_frame) || m_frame.empty())
+    {
+        close();
+        return false;
+    }//if (!m_capture.read(m_frame) || m_frame.empty())
+
+    qint64 timestamp = frameTimestamp();
+
+    const QSharedPointer<Parameters> & pParams = m_detector.parameters();
+
+    bool sampled = (m_adaptiveSampling
+                 && pParams
+                 && pParams->zone.area()
+                 && (pParams->zone & Rect(0,0,m_frame.cols,m_frame.rows)) == pParams->zone);
+
+    if (sampled)
+    {
+        bool firstFrame = m_buffer.empty();
+
+        bufferFrame(timestamp);
+
+        if (firstFrame)
+            detectBufferedFrame(0);
+        else if (static_cast<int>(m_buffer.size()) > m_probeInterval)
+            probeBuffer();
+    }//if (sampled)
+    else
+    {
+        if (m_buffer.size() > 1) probeBuffer();
+
+        m_buffer.clear();
+
+        QStringList subtitles;
+        Detector::ReturnCode result = m_detector.detect(m_frame,subtitles);
+
+        ++m_statistics.maskedFrameCount;
+
+        updateEvent(result,subtitles,timestamp);
+    }//if (sampled)...else
+
+    m_lastTimestamp = timestamp;
+    ++m_frameIndex;
+
+    ++m_statistics.frameCount;
+    m_statistics.videoMs = timestamp;
+    m_statistics.elapsedMs = m_timer.elapsed();
+
+    return true;
+}//processNextFrame
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::run Processes every remaining frame, then closes the video.
+ */
+void VideoSubtitleExtractor::run()
+{
+    while (processNextFrame()) {}
+
+    deepDebug("VideoSubtitleExtractor::run : %d frame(s), %d masked, %d event(s), %.1f fps, realtime factor %.2f",
+              m_statistics.frameCount,
+              m_statistics.maskedFrameCount,
+              m_statistics.eventCount,
+              m_statistics.fps(),
+              m_statistics.realtimeFactor());
+}//run
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::frameTimestamp Returns the timestamp of the frame just read, in milliseconds.
+ *        Computed from frame rate when known, since position reported by some backends is the next frame's one.
+ */
+qint64 VideoSubtitleExtractor::frameTimestamp()
+{
+    if (m_fps > 0.) return qRound64(1000. * m_frameIndex / m_fps);
+
+    return qRound64(m_capture.get(CV_CAP_PROP_POS_MSEC));
+}//frameTimestamp
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::bufferFrame Keeps a copy of the text zone of the frame just read.
+ */
+void VideoSubtitleExtractor::bufferFrame(qint64 _timestamp)
+{
+    m_buffer.push_back(BufferedFrame());
+
+    BufferedFrame & frame = m_buffer.back();
+    frame.zone = m_frame(m_detector.parameters()->zone).clone();//Capture may reuse frame data
+    frame.timestamp = _timestamp;
+}//bufferFrame
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::bufferedFrameBits Returns text zone mask of a buffered frame. Computed on first call.
+ */
+const PackedMask & VideoSubtitleExtractor::bufferedFrameBits(BufferedFrameVector::size_type _index)
+{
+    BufferedFrame & frame = m_buffer[_index];
+
+    if (!frame.masked)
+    {
+        m_detector.textZoneMask(frame.zone,frame.bits);
+        frame.masked = true;
+
+        ++m_statistics.maskedFrameCount;
+    }//if (!frame.masked)
+
+    return frame.bits;
+}//bufferedFrameBits
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::detectBufferedFrame Sends a buffered frame to Detector. The text zone Detector saved
+ *        becomes the reference, so probing compares frames exactly the way Detector does. Each frame is counted once
+ *        in statistics: a frame already masked while bisecting is not counted again.
+ */
+void VideoSubtitleExtractor::detectBufferedFrame(BufferedFrameVector::size_type _index)
+{
+    BufferedFrame & frame = m_buffer[_index];
+
+    QStringList subtitles;
+    Detector::ReturnCode result = m_detector.detectZone(frame.zone,subtitles);
+
+    updateEvent(result,subtitles,frame.timestamp);
+
+    if (result != Detector::RC_OK && result != Detector::RC_NO_CHANGE)
+    {
+        //Nothing was masked: reference must still move on, or probing would never end
+        m_referenceBits = bufferedFrameBits(_index);
+        return;
+    }//if (result != Detector::RC_OK && result != Detector::RC_NO_CHANGE)
+
+    if (!frame.masked) ++m_statistics.maskedFrameCount;
+
+    //Detector saved this text zone, or kept its own if they match
+    m_referenceBits = m_detector.context().referenceTextZoneBits();
+
+    if (!frame.masked)
+    {
+        frame.bits = m_referenceBits;
+        frame.masked = true;
+    }//if (!frame.masked)
+}//detectBufferedFrame
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::probeBuffer Compares last buffered frame to the reference. While they differ,
+ *        bisects buffered frames to find the first one differing from the reference, and detects it.
+ *        Only last buffered frame is kept afterwards.
+ */
+void VideoSubtitleExtractor::probeBuffer()
+{
+    BufferedFrameVector::size_type last = m_buffer.size() - 1;
+    BufferedFrameVector::size_type base = 0;//Matches the reference
+
+    while (!m_detector.textZonesMatch(m_referenceBits,bufferedFrameBits(last)))
+    {
+        BufferedFrameVector::size_type low = base;
+        BufferedFrameVector::size_type high = last;//Differs from the reference
+
+        while (high - low > 1)
+        {
+            BufferedFrameVector::size_type middle = low + (high - low) / 2;
+
+            if (m_detector.textZonesMatch(m_referenceBits,bufferedFrameBits(middle)))
+                low = middle;
+            else
+                high = middle;
+        }//while (high - low > 1)
+
+        deepDebug2("VideoSubtitleExtractor::probeBuffer : change at %lld ms.",m_buffer[high].timestamp);
+
+        //Reference is updated, thus loop ends at last when high == last
+        detectBufferedFrame(high);
+        base = high;
+    }//while (!m_detector.textZonesMatch(m_referenceBits,bufferedFrameBits(last)))
+
+    m_buffer.erase(m_buffer.begin(),m_buffer.begin() + last);
+}//probeBuffer
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::updateEvent Starts, keeps or ends current event according to detection result.
+ */
+void VideoSubtitleExtractor::updateEvent(Detector::ReturnCode _result, const QStringList & _subtitles, qint64 _timestamp)
+{
+    //Same text on screen
+    if (_result == Detector::RC_NO_CHANGE) return;
+
+    QStringList lines;
+
+    if (_result == Detector::RC_OK)
+    {
+        for (int i = 0; i < _subtitles.size(); ++i)
+        {
+            if (!_subtitles[i].isEmpty()) lines.append(_subtitles[i]);
+        }//for (int i = 0; i < _subtitles.size(); ++i)
+    }//if (_result == Detector::RC_OK)
+
+    //Pixels changed but not the text
+    if (m_eventPending && lines == m_event.lines) return;
+
+    endEvent(_timestamp);
+
+    if (!lines.isEmpty())
+    {
+        m_event.startMs = _timestamp;
+        m_event.lines = lines;
+        m_eventPending = true;
+    }//if (!lines.isEmpty())
+}//updateEvent
+
+//-------------------------
+
+/*!
+ * \brief VideoSubtitleExtractor::endEvent Ends current event, if any, and sends it to writers.
+ */
+void VideoSubtitleExtractor::endEvent(qint64 _timestamp)
+{
+    if (!m_eventPending) return;
+
+    m_event.endMs = _timestamp;
+    m_eventPending = false;
+
+    ++m_statistics.eventCount;
+
+    for (int i = 0; i < m_writers.size(); ++i)
+    {
+        m_writers[i]->write(m_event);
+    }//for (int i = 0; i < m_writers.size(); ++i)
+}//endEvent
+
+//-------------------------
+
+}//namespace SubDetection
@@ -0,0 +1,134 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SUBDETECTION_VIDEOSUBTITLEEXTRACTOR_H
+#define SUBDETECTION_VIDEOSUBTITLEEXTRACTOR_H
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+#include <vector>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include "subdetection_global.h"
+
+#include "detector.h"
+#include "subtitlewriter.h"
+
+namespace SubDetection
+{
+
+/*!
+ * \brief The VideoSubtitleExtractor class. Reads video frames and feeds a Detector. Frames are grouped into
+ *        subtitle events: an event starts when a text appears and ends when it changes or disappears.
+ *        Events are streamed to subtitle writers as soon as they end.
+ */
+class SUBDETECTIONSHARED_EXPORT VideoSubtitleExtractor
+{
+public:
+    typedef QSharedPointer<SubtitleWriter> SubtitleWriterPtr;
+
+    static const int DEFAULT_MIN_DURATION_MS = 1000;
+
+    /// Throughput measures.
+    struct Statistics
+    {
+        Statistics(): frameCount(0), maskedFrameCount(0), eventCount(0), videoMs(0), elapsedMs(0) {}
+
+        double fps() const;
+        double realtimeFactor() const;
+
+        int frameCount;///< Frames processed.
+        int maskedFrameCount;///< Frames whose text zone went through HSV masking.
+        int eventCount;///< Subtitle events found.
+        qint64 videoMs;///< Video duration processed, in milliseconds.
+        qint64 elapsedMs;///< Processing time, in milliseconds.
+    };//Statistics
+
+    explicit VideoSubtitleExtractor(Detector & _detector);
+    ~VideoSubtitleExtractor();
+
+    bool open(const QString & _videoPath);
+    bool isOpened() const {return m_capture.isOpened();}
+    void close();
+
+    void addWriter(const SubtitleWriterPtr & _pWriter);
+
+    void enableAdaptiveSampling(bool _enabled, int _minDurationMs = DEFAULT_MIN_DURATION_MS);
+
+    bool processNextFrame();
+    void run();
+
+    const Statistics & statistics() const {return m_statistics;}
+
+protected:
+    /// Text zone of a frame read in adaptive sampling mode.
+    struct BufferedFrame
+    {
+        BufferedFrame(): timestamp(0), masked(false) {}
+
+        Mat zone;
+        qint64 timestamp;
+        PackedMask bits;///< Valid if masked.
+        bool masked;
+    };//BufferedFrame
+
+    typedef std::vector<BufferedFrame> BufferedFrameVector;
+
+    qint64 frameTimestamp();
+    void bufferFrame(qint64 _timestamp);
+    const PackedMask & bufferedFrameBits(BufferedFrameVector::size_type _index);
+    void detectBufferedFrame(BufferedFrameVector::size_type _index);
+    void probeBuffer();
+    void updateEvent(Detector::ReturnCode _result, const QStringList & _subtitles, qint64 _timestamp);
+    void endEvent(qint64 _timestamp);
+
+    Detector & m_detector;
+
+    cv::VideoCapture m_capture;
+    Mat m_frame;
+
+    double m_fps;
+    qint64 m_frameIndex;
+    qint64 m_lastTimestamp;
+
+    bool m_adaptiveSampling;
+    int m_minDurationMs;
+    int m_probeInterval;///< Frames between two probes in adaptive sampling mode.
+    BufferedFrameVector m_buffer;///< Frames read since last probe. First one is last probe.
+    PackedMask m_referenceBits;///< Text zone of the frame which started current state.
+
+    bool m_eventPending;
+    SubtitleEvent m_event;
+
+    QList<SubtitleWriterPtr> m_writers;
+
+    QElapsedTimer m_timer;
+    Statistics m_statistics;
+
+private:
+    Q_DISABLE_COPY(VideoSubtitleExtractor)
+};//VideoSubtitleExtractor
+
+}//namespace SubDetection
+
+#endif // SUBDETECTION_VIDEOSUBTITLEEXTRACTOR_H
@@ -4,6 +4,7 @@
 #  - subdetection lib
 #  - subdetection test app
 #  - subdetection unit tests
+#  - subdetection benchmarks
 
 TEMPLATE = subdirs
 
@@ -12,6 +13,7 @@ CONFIG += functions
 
 CONFIG += TEST_APP
 CONFIG += UNIT_TESTS
+CONFIG += BENCHMARKS
 
 SUBDIRS = Library
 
@@ -30,3 +32,10 @@ UNIT_TESTS {
   Unit_tests.subdir = test/unit_tests
   Unit_tests.depends = library
 }
+
+BENCHMARKS {
+  SUBDIRS += Benchmarks
+
+  Benchmarks.subdir = test/benchmarks
+  Benchmarks.depends = library
+}
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# subdetection benchmarks
+#
+#-------------------------------------------------
+
+include($${PWD}/../../common.pri)
+include($${SUBDETECTION_ROOT_DIR}dependencies.pri)
+include($${SUBDETECTION_ROOT_DIR}lib/lib.pri)
+
+QT += testlib
+
+TARGET = subdetection_benchmarks
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += .
+INCLUDEPATH += $${SUBDETECTION_ROOT_DIR}/lib
+INCLUDEPATH += $$OPENCV_INC_DIR
+DEPENDPATH = $$INCLUDEPATH
+
+HEADERS += tst_benchmarks.h
+SOURCES += tst_benchmarks.cpp
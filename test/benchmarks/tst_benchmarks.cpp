@@ -0,0 +1,278 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tst_benchmarks.h"
+
+#include <QThread>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "componentlabeler.h"
+#include "detector.h"
+#include "rlemask.h"
+#include "textlinegrouper.h"
+
+namespace
+{
+typedef SubDetection::TextLineGrouper TextLineGrouper;
+
+/*!
+ * \brief createComponents Builds _count character like components in a 640x120 zone: two thirds on 3 text lines,
+ *        others are noise.
+ */
+void createComponents(int _count, SubDetection::ComponentTable & _components)
+{
+    cv::RNG rng(_count);
+
+    _components.clear();
+
+    for (int i = 0; i < _count; ++i)
+    {
+        cv::Point center;
+
+        if (i % 3)
+            center = cv::Point(rng.uniform(0,640),20 + 40 * rng.uniform(0,3) + rng.uniform(-2,3));
+        else
+            center = cv::Point(rng.uniform(0,640),rng.uniform(0,120));
+
+        _components.append(center,cv::Rect(center.x - 4,center.y - 6,8,12),96,i);
+    }//for (int i = 0; i < _count; ++i)
+}//createComponents
+
+//------
+
+/*!
+ * \brief createFrame Builds a _width x _height BGR frame of colored noise with white character like rects
+ *        on 2 lines at the bottom, roughly like a subtitled video frame.
+ */
+void createFrame(int _width, int _height, cv::Mat & _frame)
+{
+    cv::RNG rng(_width);
+
+    _frame.create(_height,_width,CV_8UC3);
+    rng.fill(_frame,cv::RNG::UNIFORM,0,256);
+
+    int charHeight = _height / 20;
+    int charWidth = charHeight / 2;
+
+    for (int line = 0; line < 2; ++line)
+    {
+        int y = _height - (3 - line) * charHeight * 3 / 2;
+
+        for (int x = _width / 4; x < 3 * _width / 4; x += charWidth * 3 / 2)
+        {
+            cv::rectangle(_frame,cv::Rect(x,y,charWidth,charHeight),cv::Scalar::all(255),CV_FILLED);
+        }//for (int x = _width / 4; x < 3 * _width / 4; x += charWidth * 3 / 2)
+    }//for (int line = 0; line < 2; ++line)
+}//createFrame
+
+//------
+
+/*!
+ * \brief addTiledRows Adds 1080p, 4K and 8K rows with 1, 2, 4 and ideal thread count.
+ */
+void addTiledRows()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("threads");
+
+    const int resolutions[][2] = {{1920,1080},{3840,2160},{7680,4320}};
+    const int threadCounts[] = {1,2,4,QThread::idealThreadCount()};
+
+    for (int r = 0; r < 3; ++r)
+    {
+        for (int t = 0; t < 4; ++t)
+        {
+            QByteArray name = QByteArray::number(resolutions[r][1]) + "p "
+                            + QByteArray::number(threadCounts[t]) + " threads";
+
+            QTest::newRow(name.constData()) << resolutions[r][0] << resolutions[r][1] << threadCounts[t];
+        }//for (int t = 0; t < 4; ++t)
+    }//for (int r = 0; r < 3; ++r)
+}//addTiledRows
+}//namespace
+
+BenchmarkTest::BenchmarkTest()
+{
+}//BenchmarkTest
+
+//-------------------------
+
+void BenchmarkTest::textLineGrouping_data()
+{
+    QTest::addColumn<int>("method");
+    QTest::addColumn<int>("componentCount");
+
+    QTest::newRow("legacy 10") << static_cast<int>(TextLineGrouper::GM_LEGACY) << 10;
+    QTest::newRow("sorted 10") << static_cast<int>(TextLineGrouper::GM_SORTED) << 10;
+    QTest::newRow("legacy 100") << static_cast<int>(TextLineGrouper::GM_LEGACY) << 100;
+    QTest::newRow("sorted 100") << static_cast<int>(TextLineGrouper::GM_SORTED) << 100;
+    QTest::newRow("legacy 1000") << static_cast<int>(TextLineGrouper::GM_LEGACY) << 1000;
+    QTest::newRow("sorted 1000") << static_cast<int>(TextLineGrouper::GM_SORTED) << 1000;
+}//textLineGrouping_data
+
+//-------------------------
+
+void BenchmarkTest::textLineGrouping()
+{
+    QFETCH(int,method);
+    QFETCH(int,componentCount);
+
+    SubDetection::ComponentTable components;
+    createComponents(componentCount,components);
+
+    TextLineGrouper grouper(static_cast<TextLineGrouper::Method>(method));
+    grouper.setTolerances(20,4);
+
+    TextLineGrouper::LineVector lines;
+
+    QBENCHMARK
+    {
+        grouper.group(components,lines);
+    }
+}//textLineGrouping
+
+//-------------------------
+
+void BenchmarkTest::tiledMasking_data()
+{
+    addTiledRows();
+}//tiledMasking_data
+
+//-------------------------
+
+void BenchmarkTest::tiledMasking()
+{
+    QFETCH(int,width);
+    QFETCH(int,height);
+    QFETCH(int,threads);
+
+    cv::Mat frame;
+    createFrame(width,height,frame);
+
+    SubDetection::Parameters params;
+    params.hsvMin = SubDetection::Hsv(0,0,200);
+    params.hsvMax = SubDetection::Hsv(180,30,255);
+    params.zone = cv::Rect(0,0,width,height);
+
+    SubDetection::Detector detector(params);
+    detector.enableTiledProcessing(true,threads);
+
+    SubDetection::PackedMask bits;
+
+    QBENCHMARK
+    {
+        detector.textZoneMask(frame,bits);
+    }
+}//tiledMasking
+
+//-------------------------
+
+void BenchmarkTest::tiledComponents_data()
+{
+    addTiledRows();
+}//tiledComponents_data
+
+//-------------------------
+
+void BenchmarkTest::tiledComponents()
+{
+    QFETCH(int,width);
+    QFETCH(int,height);
+    QFETCH(int,threads);
+
+    cv::Mat frame;
+    createFrame(width,height,frame);
+
+    //White text plus the brightest noise pixels as salt
+    cv::Mat gray;
+    cv::cvtColor(frame,gray,cv::COLOR_BGR2GRAY);
+    cv::Mat mask = gray > 200;
+
+    SubDetection::ComponentLabeler labeler;
+    labeler.setMaxThreads(threads);
+
+    SubDetection::ComponentLabeler::ComponentVector components;
+
+    QBENCHMARK
+    {
+        labeler.process(mask,components);
+    }
+}//tiledComponents
+
+//-------------------------
+
+void BenchmarkTest::runLabeling_data()
+{
+    QTest::addColumn<bool>("runs");
+    QTest::addColumn<int>("lineCount");
+
+    QTest::newRow("pixels 1 line") << false << 1;
+    QTest::newRow("runs 1 line") << true << 1;
+    QTest::newRow("pixels 2 lines") << false << 2;
+    QTest::newRow("runs 2 lines") << true << 2;
+    QTest::newRow("pixels 4 lines") << false << 4;
+    QTest::newRow("runs 4 lines") << true << 4;
+}//runLabeling_data
+
+//-------------------------
+
+void BenchmarkTest::runLabeling()
+{
+    QFETCH(bool,runs);
+    QFETCH(int,lineCount);
+
+    //1080p text zone: the more lines, the denser the mask
+    cv::Mat mask = cv::Mat::zeros(240,1920,CV_8UC1);
+
+    for (int line = 0; line < lineCount; ++line)
+    {
+        for (int x = 200; x < 1720; x += 27)
+        {
+            cv::rectangle(mask,cv::Rect(x,10 + line * 56,4,40),cv::Scalar::all(255),CV_FILLED);
+            cv::rectangle(mask,cv::Rect(x + 4,10 + line * 56,12,4),cv::Scalar::all(255),CV_FILLED);
+            cv::rectangle(mask,cv::Rect(x + 4,28 + line * 56,10,4),cv::Scalar::all(255),CV_FILLED);
+        }//for (int x = 200; x < 1720; x += 27)
+    }//for (int line = 0; line < lineCount; ++line)
+
+    SubDetection::ComponentLabeler labeler;
+    SubDetection::ComponentLabeler::ComponentVector components;
+    SubDetection::RleMask runMask;
+
+    if (runs)
+    {
+        QBENCHMARK
+        {
+            runMask.encode(mask);
+            labeler.process(runMask,components);
+        }
+    }//if (runs)
+    else
+    {
+        QBENCHMARK
+        {
+            labeler.process(mask,components);
+        }
+    }//if (runs)...else
+}//runLabeling
+
+//-------------------------
+
+QTEST_APPLESS_MAIN(BenchmarkTest)
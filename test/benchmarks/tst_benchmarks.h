@@ -0,0 +1,45 @@
+/*!
+    Copyright 2016 Broija
+
+    This file is part of subdetection library.
+
+    subdetection is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    subdetection is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with subdetection library.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TST_BENCHMARKS_H
+#define TST_BENCHMARKS_H
+
+#include <QtTest>
+
+class BenchmarkTest : public QObject
+{
+    Q_OBJECT
+
+public:
+    BenchmarkTest();
+
+private Q_SLOTS:
+    void textLineGrouping_data();
+    void textLineGrouping();
+
+    void tiledMasking_data();
+    void tiledMasking();
+
+    void tiledComponents_data();
+    void tiledComponents();
+
+    void runLabeling_data();
+    void runLabeling();
+};//BenchmarkTest
+
+#endif // TST_BENCHMARKS_H
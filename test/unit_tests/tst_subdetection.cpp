@@ -19,11 +19,34 @@
 
 #include "tst_subdetection.h"
 
+#include <QRect>
 #include <QString>
-
+#include <QTemporaryFile>
+#include <QThread>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "childindextable.h"
+#include "componentlabeler.h"
+#include "componenttable.h"
+#include "contourmanager.h"
+#include "contourrasterizer.h"
+#include "contourstore.h"
+#include "detectionpipeline.h"
+#include "detector.h"
 #include "hsv.h"
 #include "hsvlist.h"
+#include "hsvmasktable.h"
+#include "ocrcache.h"
+#include "ocrenginepool.h"
+#include "packedmask.h"
+#include "projectionlinefinder.h"
+#include "rlemask.h"
+#include "spscqueue.h"
 #include "statistical_tools.h"
+#include "subtitlewriter.h"
+#include "textlinegrouper.h"
+#include "videosubtitleextractor.h"
 
 //using namespace SubDetectionTest;
 namespace
@@ -32,6 +55,118 @@ typedef SubDetection::Hsv::Hue Hue;
 typedef SubDetection::Hsv::Saturation Saturation;
 typedef SubDetection::Hsv::Value Value;
 typedef SubDetection::HsvList HsvList;
+
+/// Builds a mask from rows separated by '|'. '#' is a set pixel.
+cv::Mat maskFromString(const QString & _rows)
+{
+    QStringList rows = _rows.split('|');
+
+    cv::Mat mask = cv::Mat::zeros(rows.size(),rows.first().size(),CV_8UC1);
+
+    for (int y = 0; y < rows.size(); ++y)
+    {
+        for (int x = 0; x < rows[y].size(); ++x)
+        {
+            if (rows[y][x] == QChar('#')) mask.at<uchar>(y,x) = 255;
+        }//for (int x = 0; x < rows[y].size(); ++x)
+    }//for (int y = 0; y < rows.size(); ++y)
+
+    return mask;
+}//maskFromString
+
+/// Detects white shapes in a _zoneSize image. Single pixels are noise, shapes bigger than 20x20 are not text.
+/// See drawTextLine for shapes making a line.
+SubDetection::Parameters detectorParameters(const cv::Size & _zoneSize)
+{
+    SubDetection::Parameters params;
+    params.hsvMin = Hsv(0,0,200);
+    params.hsvMax = Hsv(179,40,255);
+    params.zone = cv::Rect(cv::Point(0,0),_zoneSize);
+    params.charMaxSize = cv::Size(20,20);
+    params.charMinSize = cv::Size(2,2);
+    params.xTolerance = 10;
+    params.yTolerance = 2;
+    params.matchRatio = 0.5;
+
+    return params;
+}//detectorParameters
+
+/// Draws a text line of _charCount 4x6 white characters, 8 pixels apart, from _origin. Returns the line rect.
+/// At least 5 characters are needed for the line to be wide enough with detectorParameters.
+cv::Rect drawTextLine(cv::Mat & _image, const cv::Point & _origin, int _charCount)
+{
+    for (int i = 0; i < _charCount; ++i)
+    {
+        _image(cv::Rect(_origin.x + 8 * i,_origin.y,4,6)).setTo(cv::Scalar::all(255));
+    }//for (int i = 0; i < _charCount; ++i)
+
+    return cv::Rect(_origin.x,_origin.y,8 * (_charCount - 1) + 4,6);
+}//drawTextLine
+
+/// Stores the text of a line drawn by drawTextLine in _cache, so that Detector finds it without OCR.
+void cacheTextLine(SubDetection::OcrCache & _cache, const cv::Mat & _image, const cv::Rect & _line, const QString & _text)
+{
+    cv::Mat gray;
+    cv::cvtColor(_image(_line),gray,cv::COLOR_BGR2GRAY);
+
+    SubDetection::PackedMask bits;
+    bits.pack(gray);
+
+    _cache.insert(bits,".","eng",_text);
+}//cacheTextLine
+
+/// Gives access to adaptive sampling steps.
+class ProbingExtractor : public SubDetection::VideoSubtitleExtractor
+{
+public:
+    explicit ProbingExtractor(SubDetection::Detector & _detector): SubDetection::VideoSubtitleExtractor(_detector) {}
+
+    void addFrame(const cv::Mat & _frame, qint64 _timestamp) {m_frame = _frame; bufferFrame(_timestamp);}
+    void detectFirstFrame() {detectBufferedFrame(0);}
+    void probe() {probeBuffer();}
+    void update(SubDetection::Detector::ReturnCode _result, const QStringList & _subtitles, qint64 _timestamp) {updateEvent(_result,_subtitles,_timestamp);}
+    void end(qint64 _timestamp) {endEvent(_timestamp);}
+
+    int bufferSize() const {return static_cast<int>(m_buffer.size());}
+    const SubDetection::PackedMask & referenceBits() const {return m_referenceBits;}
+};//ProbingExtractor
+
+/// Pushes 0 to _count - 1 into a queue from its own thread.
+class ProducerThread : public QThread
+{
+public:
+    ProducerThread(SubDetection::SpscQueue<int> & _queue, int _count): m_queue(_queue), m_count(_count) {}
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < m_count; ++i)
+        {
+            //Consumer sleeps on an empty queue from time to time
+            if (!(i % 1000)) QThread::msleep(1);
+
+            m_queue.push(i);
+        }//for (int i = 0; i < m_count; ++i)
+    }//run
+
+    SubDetection::SpscQueue<int> & m_queue;
+    int m_count;
+};//ProducerThread
+
+/// Acquires an engine from a pool in its own thread. The engine is kept until the test releases it.
+class AcquiringThread : public QThread
+{
+public:
+    explicit AcquiringThread(SubDetection::OcrEnginePool & _pool): m_pool(_pool), m_pEngine(0) {}
+
+    SubDetection::OpticalCharRecognizer * engine() const {return m_pEngine;}
+
+protected:
+    void run() {m_pEngine = m_pool.acquire();}
+
+    SubDetection::OcrEnginePool & m_pool;
+    SubDetection::OpticalCharRecognizer * m_pEngine;
+};//AcquiringThread
 }//
 
 SubDetectionTest::SubDetectionTest()
@@ -378,6 +513,1262 @@ void SubDetectionTest::medianHsvList()
     QCOMPARE(result,expected);
 }//medianHsvList
 
+//-------------------------
+
+void SubDetectionTest::hsvMaskTable_data()
+{
+    QTest::addColumn<Hsv>("hsvMin");
+    QTest::addColumn<Hsv>("hsvMax");
+
+    QTest::newRow("yellow")
+            << Hsv(20,155,160)
+            << Hsv(32,255,255);
+
+    QTest::newRow("white")
+            << Hsv(0,0,200)
+            << Hsv(179,40,255);
+
+    QTest::newRow("full range")
+            << Hsv(0,0,0)
+            << Hsv(179,255,255);
+
+    QTest::newRow("empty range")
+            << Hsv(100,0,0)
+            << Hsv(50,255,255);
+}//hsvMaskTable_data
+
+//-------------------------
+
+void SubDetectionTest::hsvMaskTable()
+{
+    QFETCH(Hsv,hsvMin);
+    QFETCH(Hsv,hsvMax);
+
+    cv::Mat bgrMat(256,256,CV_8UC3);
+    cv::randu(bgrMat,cv::Scalar::all(0),cv::Scalar::all(256));
+
+    cv::Mat hsvMat;
+    cv::Mat expected;
+    cv::cvtColor(bgrMat,hsvMat,cv::COLOR_BGR2HSV);
+    cv::inRange(hsvMat,hsvMin.toScalar(),hsvMax.toScalar(),expected);
+
+    SubDetection::HsvMaskTable table;
+    table.setRange(hsvMin,hsvMax);
+
+    cv::Mat result;
+    table.apply(bgrMat,result);
+
+    QCOMPARE(result.type(),expected.type());
+    QCOMPARE(cv::countNonZero(result != expected),0);
+
+    //Runs computed directly give the same mask
+    SubDetection::RleMask runs;
+    table.apply(bgrMat,runs);
+
+    SubDetection::RleMask expectedRuns;
+    expectedRuns.encode(expected);
+
+    QVERIFY(runs == expectedRuns);
+    QCOMPARE(runs.count(),cv::countNonZero(expected));
+}//hsvMaskTable
+
+//-------------------------
+
+void SubDetectionTest::packedMaskDifference_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("cols");
+
+    QTest::newRow("word aligned") << 16 << 128;
+    QTest::newRow("byte aligned") << 7 << 72;
+    QTest::newRow("unaligned") << 13 << 67;
+    QTest::newRow("narrow") << 5 << 3;
+}//packedMaskDifference_data
+
+//-------------------------
+
+void SubDetectionTest::packedMaskDifference()
+{
+    QFETCH(int,rows);
+    QFETCH(int,cols);
+
+    cv::Mat first(rows,cols,CV_8UC1);
+    cv::Mat second(rows,cols,CV_8UC1);
+    cv::randu(first,cv::Scalar::all(0),cv::Scalar::all(2));
+    cv::randu(second,cv::Scalar::all(0),cv::Scalar::all(2));
+    first *= 255;
+    second *= 255;
+
+    SubDetection::PackedMask firstBits;
+    SubDetection::PackedMask secondBits;
+    firstBits.pack(first);
+    secondBits.pack(second);
+
+    QCOMPARE(firstBits.count(),cv::countNonZero(first));
+    QCOMPARE(firstBits.differenceCount(secondBits),cv::countNonZero(first != second));
+    QCOMPARE(firstBits.differenceCount(firstBits),0);
+}//packedMaskDifference
+
+//-------------------------
+
+void SubDetectionTest::ocrCache()
+{
+    cv::Mat line(12,40,CV_8UC1,cv::Scalar(0));
+    cv::rectangle(line,cv::Point(2,2),cv::Point(30,9),cv::Scalar(255),CV_FILLED);
+
+    SubDetection::PackedMask bits;
+    bits.pack(line);
+
+    SubDetection::PackedMask sameBits;
+    sameBits.pack(line.clone());
+
+    line.at<uchar>(0,0) = 255;
+    SubDetection::PackedMask otherBits;
+    otherBits.pack(line);
+
+    SubDetection::OcrCache cache;
+    QString text;
+
+    QVERIFY(!cache.find(bits,".","eng",text));
+
+    cache.insert(bits,".","eng","Hello");
+
+    QVERIFY(cache.find(sameBits,".","eng",text));
+    QCOMPARE(text,QString("Hello"));
+    QVERIFY(!cache.find(sameBits,".","fra",text));
+    QVERIFY(!cache.find(sameBits,"other","eng",text));
+    QVERIFY(!cache.find(otherBits,".","eng",text));
+    QCOMPARE(cache.hits(),1);
+    QCOMPARE(cache.misses(),4);
+
+    //Save then load into a new cache
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.close();
+    QVERIFY(cache.save(file.fileName()));
+
+    SubDetection::OcrCache loaded;
+    QVERIFY(loaded.load(file.fileName()));
+    QCOMPARE(loaded.count(),1);
+    QVERIFY(loaded.find(bits,".","eng",text));
+    QVERIFY(!loaded.find(bits,"other","eng",text));
+    QCOMPARE(text,QString("Hello"));
+
+    //Least recently used entry is dropped when budget is exceeded
+    SubDetection::OcrCache small(cache.totalBytes() + cache.totalBytes() / 2);
+    small.insert(bits,".","eng","Hello");
+    small.insert(otherBits,".","eng","Hullo");
+    QVERIFY(!small.find(bits,".","eng",text));
+    QVERIFY(small.find(otherBits,".","eng",text));
+
+    //Saving and loading keep the order in which entries are dropped
+    line.at<uchar>(0,1) = 255;
+    SubDetection::PackedMask thirdBits;
+    thirdBits.pack(line);
+
+    const int twoEntryBytes = 2 * cache.totalBytes() + cache.totalBytes() / 2;
+
+    SubDetection::OcrCache pair(twoEntryBytes);
+    pair.insert(bits,".","eng","Hello");
+    pair.insert(otherBits,".","eng","Hullo");
+    QVERIFY(pair.find(bits,".","eng",text));
+    QVERIFY(pair.save(file.fileName()));
+
+    SubDetection::OcrCache loadedPair(twoEntryBytes);
+    QVERIFY(loadedPair.load(file.fileName()));
+
+    pair.insert(thirdBits,".","eng","Hallo");
+    QVERIFY(!pair.find(otherBits,".","eng",text));
+    QVERIFY(pair.find(bits,".","eng",text));
+
+    loadedPair.insert(thirdBits,".","eng","Hallo");
+    QVERIFY(!loadedPair.find(otherBits,".","eng",text));
+    QVERIFY(loadedPair.find(bits,".","eng",text));
+}//ocrCache
+
+//-------------------------
+
+void SubDetectionTest::ocrEnginePool()
+{
+    SubDetection::OcrEnginePool pool(QString(),"eng",0,1);
+    QCOMPARE(pool.size(),0);
+
+    SubDetection::OpticalCharRecognizer * pFirst = pool.acquire();
+    QVERIFY(pFirst);
+    QVERIFY(!pool.tryAcquire());
+
+    //Maximum size reached: acquire waits for a release
+    AcquiringThread releaseWaiter(pool);
+    releaseWaiter.start();
+    QVERIFY(!releaseWaiter.wait(100));
+
+    pool.release(pFirst);
+    QVERIFY(releaseWaiter.wait(5000));
+    QVERIFY(releaseWaiter.engine() == pFirst);
+
+    //Raising maximum size lets a waiting thread create an engine
+    AcquiringThread sizeWaiter(pool);
+    sizeWaiter.start();
+    QVERIFY(!sizeWaiter.wait(100));
+
+    pool.setMaximumSize(2);
+    QVERIFY(sizeWaiter.wait(5000));
+    QVERIFY(sizeWaiter.engine());
+    QVERIFY(sizeWaiter.engine() != pFirst);
+    QCOMPARE(pool.size(),2);
+
+    pool.release(releaseWaiter.engine());
+    pool.release(sizeWaiter.engine());
+    QCOMPARE(pool.idleCount(),2);
+}//ocrEnginePool
+
+//-------------------------
+
+void SubDetectionTest::subtitleTimestamp_data()
+{
+    QTest::addColumn<qint64>("ms");
+    QTest::addColumn<QString>("srt");
+    QTest::addColumn<QString>("webVtt");
+
+    QTest::newRow("zero") << Q_INT64_C(0) << QString("00:00:00,000") << QString("00:00:00.000");
+    QTest::newRow("milliseconds") << Q_INT64_C(7) << QString("00:00:00,007") << QString("00:00:00.007");
+    QTest::newRow("minutes") << Q_INT64_C(754321) << QString("00:12:34,321") << QString("00:12:34.321");
+    QTest::newRow("hours") << Q_INT64_C(36610001) << QString("10:10:10,001") << QString("10:10:10.001");
+}//subtitleTimestamp_data
+
+//-------------------------
+
+void SubDetectionTest::subtitleTimestamp()
+{
+    QFETCH(qint64,ms);
+    QFETCH(QString,srt);
+    QFETCH(QString,webVtt);
+
+    QCOMPARE(SubDetection::SubtitleWriter::timestamp(ms,SubDetection::SubtitleWriter::SF_SRT),srt);
+    QCOMPARE(SubDetection::SubtitleWriter::timestamp(ms,SubDetection::SubtitleWriter::SF_WEBVTT),webVtt);
+}//subtitleTimestamp
+
+//-------------------------
+
+void SubDetectionTest::subtitleEvents()
+{
+    SubDetection::Detector detector(detectorParameters(cv::Size(16,16)));
+    ProbingExtractor extractor(detector);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.close();
+
+    SubDetection::VideoSubtitleExtractor::SubtitleWriterPtr pWriter(new SubDetection::SubtitleWriter(SubDetection::SubtitleWriter::SF_SRT));
+    QVERIFY(pWriter->open(file.fileName()));
+    extractor.addWriter(pWriter);
+
+    extractor.update(SubDetection::Detector::RC_OK,QStringList() << "Hello",0);
+    extractor.update(SubDetection::Detector::RC_NO_CHANGE,QStringList(),500);//Same text on screen
+    extractor.update(SubDetection::Detector::RC_OK,QStringList() << "Hello" << "",1000);//Pixels changed, not the text
+    extractor.update(SubDetection::Detector::RC_OK,QStringList() << "World",2000);
+    extractor.update(SubDetection::Detector::RC_OK,QStringList(),3000);//Text disappears
+    extractor.update(SubDetection::Detector::RC_NO_RESULT,QStringList(),3500);//Nothing to end
+    extractor.update(SubDetection::Detector::RC_OK,QStringList() << "Good" << "bye",4000);
+    extractor.update(SubDetection::Detector::RC_INVALID_INPUT_IMAGE,QStringList() << "Ignored",4500);
+    extractor.update(SubDetection::Detector::RC_OK,QStringList() << "Last",5000);
+    extractor.end(6000);
+    extractor.end(7000);//Already ended
+
+    QCOMPARE(extractor.statistics().eventCount,4);
+    QCOMPARE(pWriter->eventCount(),4);
+    pWriter->close();
+
+    QVERIFY(file.open());
+    QCOMPARE(QString::fromUtf8(file.readAll()),
+             QString("1\n00:00:00,000 --> 00:00:02,000\nHello\n\n"
+                     "2\n00:00:02,000 --> 00:00:03,000\nWorld\n\n"
+                     "3\n00:00:04,000 --> 00:00:04,500\nGood\nbye\n\n"
+                     "4\n00:00:05,000 --> 00:00:06,000\nLast\n\n"));
+}//subtitleEvents
+
+//-------------------------
+
+void SubDetectionTest::spscQueue()
+{
+    SubDetection::SpscQueue<int> queue(3);
+    int item = 0;
+
+    QCOMPARE(queue.capacity(),3);
+    QVERIFY(!queue.tryPop(item));
+
+    //Wrapping around the ring several times
+    for (int round = 0; round < 4; ++round)
+    {
+        QVERIFY(queue.tryPush(round * 10 + 1));
+        QVERIFY(queue.tryPush(round * 10 + 2));
+        QVERIFY(queue.tryPush(round * 10 + 3));
+        QVERIFY(!queue.tryPush(0));
+
+        for (int i = 1; i <= 3; ++i)
+        {
+            QVERIFY(queue.tryPop(item));
+            QCOMPARE(item,round * 10 + i);
+        }//for (int i = 1; i <= 3; ++i)
+
+        QVERIFY(!queue.tryPop(item));
+    }//for (int round = 0; round < 4; ++round)
+}//spscQueue
+
+//-------------------------
+
+void SubDetectionTest::spscQueueThreads()
+{
+    const int itemCount = 100000;
+
+    SubDetection::SpscQueue<int> queue(4);
+
+    ProducerThread producer(queue,itemCount);
+    producer.start();
+
+    int item = -1;
+
+    for (int i = 0; i < itemCount; ++i)
+    {
+        //Producer sleeps on a full queue from time to time
+        if (!(i % 777)) QThread::msleep(1);
+
+        queue.pop(item);
+
+        QCOMPARE(item,i);
+    }//for (int i = 0; i < itemCount; ++i)
+
+    QVERIFY(producer.wait(5000));
+    QVERIFY(!queue.tryPop(item));
+}//spscQueueThreads
+
+//-------------------------
+
+void SubDetectionTest::componentLabeler_data()
+{
+    QTest::addColumn<QString>("mask");
+    QTest::addColumn<QList<int> >("areas");
+
+    QTest::newRow("empty") << QString("....|....") << QList<int>();
+    QTest::newRow("diagonal") << QString("#...|.#..|..#.") << (QList<int>() << 3);
+    QTest::newRow("merged branches") << QString("#.#|#.#|###") << (QList<int>() << 7);
+    QTest::newRow("zigzag") << QString("#.#.#|.#.#.") << (QList<int>() << 5);
+    QTest::newRow("separated") << QString("##..#|##..#") << (QList<int>() << 4 << 2);
+    QTest::newRow("ring and inner dot") << QString("#####|#...#|#.#.#|#...#|#####") << (QList<int>() << 16 << 1);
+}//componentLabeler_data
+
+//-------------------------
+
+void SubDetectionTest::componentLabeler()
+{
+    QFETCH(QString,mask);
+    QFETCH(QList<int>,areas);
+
+    cv::Mat mat = maskFromString(mask);
+
+    SubDetection::ComponentLabeler labeler;
+    SubDetection::ComponentLabeler::ComponentVector components;
+    labeler.process(mat,components);
+
+    QCOMPARE(static_cast<int>(components.size()),areas.size());
+
+    int area = 0;
+
+    for (int i = 0; i < areas.size(); ++i)
+    {
+        QCOMPARE(components[i].area,areas[i]);
+        QVERIFY(components[i].bounding.contains(components[i].massCenter));
+
+        area += components[i].area;
+    }//for (int i = 0; i < areas.size(); ++i)
+
+    QCOMPARE(area,cv::countNonZero(mat));
+
+    //Run based labeling finds the same components
+    SubDetection::RleMask runs;
+    runs.encode(mat);
+
+    cv::Mat decoded;
+    runs.decode(decoded);
+    QCOMPARE(cv::countNonZero(decoded != mat),0);
+
+    SubDetection::ComponentLabeler::ComponentVector runComponents;
+    labeler.process(runs,runComponents);
+
+    QCOMPARE(labeler.labeledRowCount(),mat.rows);
+    QCOMPARE(runComponents.size(),components.size());
+
+    for (SubDetection::ComponentLabeler::ComponentVector::size_type i = 0; i < components.size(); ++i)
+    {
+        QCOMPARE(runComponents[i].area,components[i].area);
+        QVERIFY(runComponents[i].bounding == components[i].bounding);
+        QVERIFY(runComponents[i].massCenter == components[i].massCenter);
+    }//for (SubDetection::ComponentLabeler::ComponentVector::size_type i = 0; i < components.size(); ++i)
+
+    //Part of the mask read from runs only
+    cv::Rect roi(1,1,mat.cols - 1,mat.rows - 1);
+
+    SubDetection::PackedMask roiBits;
+    SubDetection::PackedMask runRoiBits;
+    roiBits.pack(mat(roi));
+    runRoiBits.pack(runs,roi);
+    QVERIFY(runRoiBits == roiBits);
+
+    cv::Mat roiDecoded = cv::Mat::zeros(mat.size(),CV_8UC1);
+    runs.decode(roiDecoded,roi);
+    QCOMPARE(cv::countNonZero(roiDecoded(roi) != mat(roi)),0);
+    QCOMPARE(cv::countNonZero(roiDecoded),cv::countNonZero(mat(roi)));
+}//componentLabeler
+
+//-------------------------
+
+void SubDetectionTest::componentLabelerBands_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::addColumn<int>("density");
+
+    QTest::newRow("2 threads sparse") << 2 << 20;
+    QTest::newRow("4 threads dense") << 4 << 55;
+    QTest::newRow("8 threads dense") << 8 << 55;
+    QTest::newRow("more threads than bands") << 64 << 40;
+}//componentLabelerBands_data
+
+//-------------------------
+
+void SubDetectionTest::componentLabelerBands()
+{
+    QFETCH(int,threads);
+    QFETCH(int,density);
+
+    //Tall enough for 8 bands of 64 rows, with components crossing band seams
+    cv::Mat noise(520,97,CV_8UC1);
+    cv::RNG rng(12345);
+    rng.fill(noise,cv::RNG::UNIFORM,0,100);
+
+    cv::Mat mask = noise < density;
+
+    SubDetection::ComponentLabeler singleLabeler;
+    SubDetection::ComponentLabeler::ComponentVector expected;
+    singleLabeler.process(mask,expected);
+
+    SubDetection::ComponentLabeler bandLabeler;
+    bandLabeler.setMaxThreads(threads);
+    QCOMPARE(bandLabeler.maxThreads(),threads);
+
+    SubDetection::ComponentLabeler::ComponentVector components;
+    bandLabeler.process(mask,components);
+
+    QCOMPARE(components.size(),expected.size());
+
+    for (SubDetection::ComponentLabeler::ComponentVector::size_type i = 0; i < expected.size(); ++i)
+    {
+        QCOMPARE(components[i].area,expected[i].area);
+        QVERIFY(components[i].bounding == expected[i].bounding);
+        QVERIFY(components[i].massCenter == expected[i].massCenter);
+    }//for (SubDetection::ComponentLabeler::ComponentVector::size_type i = 0; i < expected.size(); ++i)
+}//componentLabelerBands
+
+//-------------------------
+
+void SubDetectionTest::tiledMasking_data()
+{
+    QTest::addColumn<int>("method");
+
+    QTest::newRow("conversion") << static_cast<int>(SubDetection::Detector::MM_CONVERSION);
+    QTest::newRow("lookup table") << static_cast<int>(SubDetection::Detector::MM_LOOKUP_TABLE);
+}//tiledMasking_data
+
+//-------------------------
+
+void SubDetectionTest::tiledMasking()
+{
+    QFETCH(int,method);
+
+    //4 bands of 64 rows
+    const cv::Size zoneSize(150,256);
+
+    cv::Mat zone(zoneSize,CV_8UC3);
+    cv::RNG rng(12345);
+    rng.fill(zone,cv::RNG::UNIFORM,0,256);
+
+    SubDetection::Parameters params = detectorParameters(zoneSize);
+    params.hsvMin = Hsv(20,50,50);
+    params.hsvMax = Hsv(120,255,255);
+
+    SubDetection::Detector singleDetector(params);
+    singleDetector.setMaskingMethod(static_cast<SubDetection::Detector::MaskingMethod>(method));
+
+    SubDetection::Detector tiledDetector(params);
+    tiledDetector.setMaskingMethod(static_cast<SubDetection::Detector::MaskingMethod>(method));
+    tiledDetector.enableTiledProcessing(true,4);
+
+    SubDetection::PackedMask expected;
+    SubDetection::PackedMask bits;
+    singleDetector.textZoneMask(zone,expected);
+    tiledDetector.textZoneMask(zone,bits);
+
+    QVERIFY(expected.count() > 0);
+    QVERIFY(expected.count() < zoneSize.area());
+    QVERIFY(bits == expected);
+}//tiledMasking
+
+//-------------------------
+
+void SubDetectionTest::componentLabelerIncremental()
+{
+    cv::Mat mask = cv::Mat::zeros(160,200,CV_8UC1);
+
+    //First line
+    for (int x = 10; x < 190; x += 12)
+    {
+        cv::rectangle(mask,cv::Rect(x,20,8,14),cv::Scalar::all(255),CV_FILLED);
+    }//for (int x = 10; x < 190; x += 12)
+
+    SubDetection::ComponentLabeler labeler;
+    labeler.enableIncrementalLabeling(true);
+
+    SubDetection::ComponentLabeler::ComponentVector components;
+    labeler.process(mask,components);
+
+    QCOMPARE(labeler.labeledRowCount(),mask.rows);
+
+    //Same mask: everything is reused
+    labeler.process(mask,components);
+
+    QCOMPARE(labeler.labeledRowCount(),0);
+    QCOMPARE(components.size(),static_cast<SubDetection::ComponentLabeler::ComponentVector::size_type>(15));
+
+    //Second line appears under the first one, and a character of the first line grows down to a seam
+    for (int x = 10; x < 190; x += 12)
+    {
+        cv::rectangle(mask,cv::Rect(x,120,8,14),cv::Scalar::all(255),CV_FILLED);
+    }//for (int x = 10; x < 190; x += 12)
+
+    cv::rectangle(mask,cv::Rect(34,20,8,30),cv::Scalar::all(255),CV_FILLED);
+
+    labeler.process(mask,components);
+
+    QVERIFY(labeler.labeledRowCount() > 0);
+    QVERIFY(labeler.labeledRowCount() < mask.rows);
+
+    SubDetection::ComponentLabeler fullLabeler;
+    SubDetection::ComponentLabeler::ComponentVector expected;
+    fullLabeler.process(mask,expected);
+
+    QCOMPARE(components.size(),expected.size());
+
+    for (SubDetection::ComponentLabeler::ComponentVector::size_type i = 0; i < expected.size(); ++i)
+    {
+        QCOMPARE(components[i].area,expected[i].area);
+        QVERIFY(components[i].bounding == expected[i].bounding);
+        QVERIFY(components[i].massCenter == expected[i].massCenter);
+    }//for (SubDetection::ComponentLabeler::ComponentVector::size_type i = 0; i < expected.size(); ++i)
+
+    //Disabling forgets previous mask
+    labeler.enableIncrementalLabeling(false);
+    labeler.process(mask,components);
+
+    QCOMPARE(labeler.labeledRowCount(),mask.rows);
+}//componentLabelerIncremental
+
+//-------------------------
+
+void SubDetectionTest::contourManagerBinaryInput()
+{
+    cv::Mat mask = cv::Mat::zeros(60,120,CV_8UC1);
+    cv::rectangle(mask,cv::Point(5,5),cv::Point(20,30),cv::Scalar::all(255),CV_FILLED);
+    cv::rectangle(mask,cv::Point(40,10),cv::Point(45,50),cv::Scalar::all(255),CV_FILLED);
+    cv::circle(mask,cv::Point(90,30),15,cv::Scalar::all(255),CV_FILLED);
+
+    cv::Mat original = mask.clone();
+
+    cv::Mat color;
+    cv::cvtColor(mask,color,cv::COLOR_GRAY2BGR);
+
+    SubDetection::ContourManager::SelectionFlags flags = SubDetection::ContourManager::SFBoundings | SubDetection::ContourManager::SFMassCenters;
+
+    SubDetection::ContourManager colorManager;
+    colorManager.process(color,flags);
+
+    SubDetection::ContourManager binaryManager;
+    binaryManager.process(mask,SubDetection::ContourManager::IF_BINARY,flags);
+
+    SubDetection::RectVector colorBoundings;
+    SubDetection::RectVector binaryBoundings;
+    colorManager.boundingRects(colorBoundings);
+    binaryManager.boundingRects(binaryBoundings);
+
+    QCOMPARE(binaryBoundings.size(),static_cast<SubDetection::RectVector::size_type>(3));
+    QVERIFY(binaryBoundings == colorBoundings);
+
+    QVERIFY(binaryManager.boundingRects() == binaryBoundings);
+
+    //Input mask is left untouched
+    QCOMPARE(cv::countNonZero(mask != original),0);
+
+    //Taken attributes are moved out of the manager
+    SubDetection::ContourManager::Attributes attributes;
+    binaryManager.takeAttributes(attributes);
+
+    QVERIFY(attributes.boundings == binaryBoundings);
+    QCOMPARE(attributes.massCenters.size(),binaryBoundings.size());
+    QVERIFY(binaryManager.boundingRects().empty());
+}//contourManagerBinaryInput
+
+//-------------------------
+
+void SubDetectionTest::contourManagerNoiseLimits_data()
+{
+    QTest::addColumn<int>("extractionMethod");
+
+    QTest::newRow("contours") << static_cast<int>(SubDetection::ContourManager::EM_CONTOURS);
+    QTest::newRow("components") << static_cast<int>(SubDetection::ContourManager::EM_COMPONENTS);
+    QTest::newRow("runs") << static_cast<int>(SubDetection::ContourManager::EM_RUNS);
+}//contourManagerNoiseLimits_data
+
+//-------------------------
+
+void SubDetectionTest::contourManagerNoiseLimits()
+{
+    QFETCH(int,extractionMethod);
+
+    cv::Mat mask = cv::Mat::zeros(60,120,CV_8UC1);
+    cv::rectangle(mask,cv::Point(5,5),cv::Point(20,30),cv::Scalar::all(255),CV_FILLED);
+    cv::rectangle(mask,cv::Point(40,10),cv::Point(45,50),cv::Scalar::all(255),CV_FILLED);
+    cv::rectangle(mask,cv::Point(60,10),cv::Point(90,10),cv::Scalar::all(255),CV_FILLED);//Scratch: too thin
+
+    //Salt noise
+    const int saltCount = 6;
+    for (int i = 0; i < saltCount; ++i)
+    {
+        mask.at<uchar>(55,5 + i * 10) = 255;
+    }//for (int i = 0; i < saltCount; ++i)
+
+    SubDetection::ContourManager manager;
+    manager.setExtractionMethod(static_cast<SubDetection::ContourManager::ExtractionMethod>(extractionMethod));
+    manager.setNoiseLimits(cv::Size(2,2),4);
+    manager.process(mask,SubDetection::ContourManager::IF_BINARY,SubDetection::ContourManager::SFBoundings | SubDetection::ContourManager::SFMassCenters);
+
+    QCOMPARE(manager.droppedCount(),saltCount + 1);
+    QCOMPARE(manager.boundingRects().size(),static_cast<SubDetection::RectVector::size_type>(2));
+    QCOMPARE(manager.massCenters().size(),manager.boundingRects().size());
+
+    //Limits disabled
+    manager.setNoiseLimits(cv::Size(0,0),0);
+    manager.process(mask,SubDetection::ContourManager::IF_BINARY,SubDetection::ContourManager::SFBoundings | SubDetection::ContourManager::SFMassCenters);
+
+    QCOMPARE(manager.droppedCount(),0);
+    QCOMPARE(manager.boundingRects().size(),static_cast<SubDetection::RectVector::size_type>(saltCount + 3));
+}//contourManagerNoiseLimits
+
+//-------------------------
+
+void SubDetectionTest::contourStore()
+{
+    cv::Mat mask = cv::Mat::zeros(60,120,CV_8UC1);
+    cv::rectangle(mask,cv::Point(5,5),cv::Point(50,50),cv::Scalar::all(255),CV_FILLED);
+    cv::rectangle(mask,cv::Point(10,10),cv::Point(25,25),cv::Scalar::all(0),CV_FILLED);//Hole
+    cv::rectangle(mask,cv::Point(14,14),cv::Point(18,18),cv::Scalar::all(255),CV_FILLED);//Island in hole
+    cv::circle(mask,cv::Point(90,30),15,cv::Scalar::all(255),CV_FILLED);
+
+    SubDetection::ContourVector expectedContours;
+    SubDetection::Hierarchy expectedHierarchy;
+    cv::Mat expectedMat = mask.clone();
+    cv::findContours(expectedMat,expectedContours,expectedHierarchy,CV_RETR_TREE,CV_CHAIN_APPROX_NONE);
+
+    SubDetection::ContourStore store;
+    SubDetection::Hierarchy hierarchy;
+
+    //Second search reuses buffers and must give the same result
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        cv::Mat mat = mask.clone();
+        store.find(mat,hierarchy,CV_RETR_TREE,CV_CHAIN_APPROX_NONE);
+
+        QCOMPARE(store.size(),static_cast<int>(expectedContours.size()));
+        QVERIFY(hierarchy == expectedHierarchy);
+
+        SubDetection::ContourVector contours;
+        store.contours(contours);
+        QVERIFY(contours == expectedContours);
+
+        for (int i = 0; i < store.size(); ++i)
+        {
+            QVERIFY(cv::boundingRect(store.view(i)) == cv::boundingRect(expectedContours[i]));
+        }//for (int i = 0; i < store.size(); ++i)
+    }//for (int pass = 0; pass < 2; ++pass)
+
+    store.clear();
+    QVERIFY(store.isEmpty());
+}//contourStore
+
+//-------------------------
+
+void SubDetectionTest::childIndexTable()
+{
+    //0: outer border with holes 1 and 2, 3: island in hole 1, 4: other outer border
+    SubDetection::Hierarchy hierarchy;
+    hierarchy.push_back(SubDetection::HierarchyItem(4,-1,1,-1));
+    hierarchy.push_back(SubDetection::HierarchyItem(2,-1,3,0));
+    hierarchy.push_back(SubDetection::HierarchyItem(-1,1,-1,0));
+    hierarchy.push_back(SubDetection::HierarchyItem(-1,-1,-1,1));
+    hierarchy.push_back(SubDetection::HierarchyItem(-1,0,-1,-1));
+
+    SubDetection::ChildIndexTable table;
+    table.build(hierarchy);
+
+    QCOMPARE(table.size(),5);
+
+    for (int i = 0; i < table.size(); ++i)
+    {
+        SubDetection::IndexVector children;
+        SubDetection::ContourManager::children(hierarchy,i,children);
+
+        QCOMPARE(table.childCount(i),SubDetection::ContourManager::childCount(hierarchy,i));
+        QVERIFY(SubDetection::IndexVector(table.children(i),table.children(i) + table.childCount(i)) == children);
+        QCOMPARE(table.parent(i),hierarchy[i][3]);
+    }//for (int i = 0; i < table.size(); ++i)
+
+    QVERIFY(!table.isHole(0));
+    QVERIFY(table.isHole(1));
+    QVERIFY(table.isHole(2));
+    QVERIFY(!table.isHole(3));
+    QVERIFY(!table.isHole(4));
+
+    table.clear();
+    QVERIFY(table.isEmpty());
+}//childIndexTable
+
+//-------------------------
+
+void SubDetectionTest::contourRasterizer_data()
+{
+    QTest::addColumn<int>("approxMethod");
+
+    QTest::newRow("all points") << static_cast<int>(CV_CHAIN_APPROX_NONE);
+    QTest::newRow("simple") << static_cast<int>(CV_CHAIN_APPROX_SIMPLE);
+}//contourRasterizer_data
+
+//-------------------------
+
+void SubDetectionTest::contourRasterizer()
+{
+    QFETCH(int,approxMethod);
+
+    //Glyph like shape with two holes, one touching a thin diagonal stroke
+    cv::Mat mask = cv::Mat::zeros(60,80,CV_8UC1);
+    cv::circle(mask,cv::Point(30,30),22,cv::Scalar::all(255),CV_FILLED);
+    cv::circle(mask,cv::Point(22,24),7,cv::Scalar::all(0),CV_FILLED);
+    cv::rectangle(mask,cv::Point(30,34),cv::Point(40,42),cv::Scalar::all(0),CV_FILLED);
+    cv::line(mask,cv::Point(30,42),cv::Point(40,34),cv::Scalar::all(255));
+    cv::line(mask,cv::Point(50,10),cv::Point(70,50),cv::Scalar::all(255),3);
+
+    SubDetection::ContourVector contours;
+    SubDetection::Hierarchy hierarchy;
+    cv::findContours(mask,contours,hierarchy,CV_RETR_CCOMP,approxMethod);
+
+    for (int outer = 0; outer >= 0; outer = hierarchy[outer][0])
+    {
+        SubDetection::ContourVector holes;
+        SubDetection::ContourManager::children(contours,hierarchy,outer,holes);
+
+        //Same area as Blob traversal: bottom right corner included
+        cv::Rect bounding = cv::boundingRect(contours[outer]);
+        cv::Rect area(bounding.x - 1,bounding.y - 1,bounding.width + 3,bounding.height + 3);
+
+        SubDetection::ContourRasterizer rasterizer;
+        rasterizer.reset(area);
+        rasterizer.setContour(&contours[outer][0],static_cast<int>(contours[outer].size()));
+
+        for (SubDetection::ContourVector::size_type i = 0; i < holes.size(); ++i)
+        {
+            rasterizer.addHole(&holes[i][0],static_cast<int>(holes[i].size()));
+        }//for (SubDetection::ContourVector::size_type i = 0; i < holes.size(); ++i)
+
+        for (int y = area.y; y < area.y + area.height; ++y)
+        {
+            for (int x = area.x; x < area.x + area.width; ++x)
+            {
+                cv::Point pixel(x,y);
+                int test = static_cast<int>(cv::pointPolygonTest(contours[outer],pixel,false));
+
+                SubDetection::ContourRasterizer::Location expected = SubDetection::ContourRasterizer::L_EDGE;
+
+                if (test < 0)
+                {
+                    expected = SubDetection::ContourRasterizer::L_OUTSIDE;
+                }//if (test < 0)
+                else if (test > 0)
+                {
+                    expected = SubDetection::ContourRasterizer::L_INSIDE;
+
+                    for (SubDetection::ContourVector::size_type i = 0; i < holes.size(); ++i)
+                    {
+                        if (cv::pointPolygonTest(holes[i],pixel,false) >= 0.) expected = SubDetection::ContourRasterizer::L_HOLE;
+                    }//for (SubDetection::ContourVector::size_type i = 0; i < holes.size(); ++i)
+                }//else if (test > 0)
+
+                QCOMPARE(static_cast<int>(rasterizer.location(x,y)),static_cast<int>(expected));
+            }//for (int x = area.x; x < area.x + area.width; ++x)
+        }//for (int y = area.y; y < area.y + area.height; ++y)
+    }//for (int outer = 0; outer >= 0; outer = hierarchy[outer][0])
+}//contourRasterizer
+
+//-------------------------
+
+void SubDetectionTest::componentTableFilter()
+{
+    SubDetection::ComponentTable components;
+    components.append(cv::Point(5,5),cv::Rect(3,3,4,4),16,0);
+    components.append(cv::Point(5,5),cv::Rect(4,2,3,6),18,1);//Same mass center, distinct component
+    components.append(cv::Point(50,5),cv::Rect(48,3,4,4),16,2);//Out of zone
+    components.append(cv::Point(8,8),cv::Rect(0,0,20,20),400,3);//Too big
+    components.append(cv::Point(9,2),cv::Rect(8,1,3,3),9,4);
+
+    SubDetection::ComponentTable result;
+    components.filter(cv::Rect(0,0,20,20),cv::Size(10,10),result);
+
+    QCOMPARE(result.size(),3);
+    QVERIFY(result.indexes[0] == 0 && result.indexes[1] == 1 && result.indexes[2] == 4);
+    QVERIFY(result.boundings[1] == cv::Rect(4,2,3,6));
+    QCOMPARE(result.areas[2],9);
+}//componentTableFilter
+
+//-------------------------
+
+void SubDetectionTest::textLineGrouper_data()
+{
+    QTest::addColumn<int>("pointCount");
+    QTest::addColumn<int>("xTolerance");
+    QTest::addColumn<int>("yTolerance");
+
+    QTest::newRow("10 points") << 10 << 20 << 2;
+    QTest::newRow("100 points") << 100 << 20 << 4;
+    QTest::newRow("1000 points") << 1000 << 10 << 4;
+    QTest::newRow("no tolerance") << 300 << 0 << 0;
+}//textLineGrouper_data
+
+//-------------------------
+
+void SubDetectionTest::textLineGrouper()
+{
+    QFETCH(int,pointCount);
+    QFETCH(int,xTolerance);
+    QFETCH(int,yTolerance);
+
+    cv::RNG rng(pointCount);
+
+    SubDetection::ComponentTable components;
+
+    for (int i = 0; i < pointCount; ++i)
+    {
+        //Small zone so that points share coordinates
+        cv::Point center(rng.uniform(0,200),rng.uniform(0,40));
+        cv::Rect bounding(center.x - rng.uniform(0,5),center.y - rng.uniform(0,8),rng.uniform(1,10),rng.uniform(1,16));
+
+        components.append(center,bounding,bounding.area(),i);
+    }//for (int i = 0; i < pointCount; ++i)
+
+    SubDetection::TextLineGrouper legacy(SubDetection::TextLineGrouper::GM_LEGACY);
+    SubDetection::TextLineGrouper sorted(SubDetection::TextLineGrouper::GM_SORTED);
+    legacy.setTolerances(xTolerance,yTolerance);
+    sorted.setTolerances(xTolerance,yTolerance);
+
+    SubDetection::TextLineGrouper::LineVector legacyLines;
+    SubDetection::TextLineGrouper::LineVector sortedLines;
+    legacy.group(components,legacyLines);
+    sorted.group(components,sortedLines);
+
+    QCOMPARE(sortedLines.size(),legacyLines.size());
+
+    for (SubDetection::TextLineGrouper::LineVector::size_type i = 0; i < legacyLines.size(); ++i)
+    {
+        QVERIFY(sortedLines[i].rect == legacyLines[i].rect);
+        QCOMPARE(sortedLines[i].count,legacyLines[i].count);
+        QVERIFY(sortedLines[i].indexes == legacyLines[i].indexes);
+    }//for (SubDetection::TextLineGrouper::LineVector::size_type i = 0; i < legacyLines.size(); ++i)
+}//textLineGrouper
+
+//-------------------------
+
+void SubDetectionTest::projectionLineFinder_data()
+{
+    QTest::addColumn<QString>("mask");
+    QTest::addColumn<bool>("found");
+    QTest::addColumn<int>("lineCount");
+    QTest::addColumn<QRect>("firstLine");
+
+    QTest::newRow("empty") << "............|............" << true << 0 << QRect();
+    QTest::newRow("two lines") << "##.##.##.##.|##.##.##.##.|............|............|.##.##.##.##|.##.##.##.##" << true << 2 << QRect(0,0,11,2);
+    QTest::newRow("accent") << "...#........|............|##.##.##.##.|##.##.##.##." << true << 1 << QRect(0,0,11,4);
+    QTest::newRow("too tall") << ".####.|.####.|.####.|.####.|.####." << false << 0 << QRect();
+    QTest::newRow("two groups") << "##......##|##......##" << false << 0 << QRect();
+    QTest::newRow("too narrow") << ".##...|.##..." << false << 0 << QRect();
+    QTest::newRow("two characters") << "##.##.......|##.##......." << false << 0 << QRect();
+    QTest::newRow("solid bar") << ".##########.|.##########." << false << 0 << QRect();
+    QTest::newRow("wide shape") << "##.##.#####.|##.##.#####." << false << 0 << QRect();
+    QTest::newRow("spaced characters") << "####.####.####|####.####.####" << false << 0 << QRect();
+    QTest::newRow("speck as character") << "##.##.##.#..|##.##.##...." << false << 0 << QRect();
+    QTest::newRow("trailing speck") << "##.##.##.##.#|##.##.##.##.." << true << 1 << QRect(0,0,11,2);
+}//projectionLineFinder_data
+
+//-------------------------
+
+void SubDetectionTest::projectionLineFinder()
+{
+    QFETCH(QString,mask);
+    QFETCH(bool,found);
+    QFETCH(int,lineCount);
+    QFETCH(QRect,firstLine);
+
+    SubDetection::ProjectionLineFinder finder;
+    finder.setCharMaxSize(cv::Size(4,4));
+    finder.setNoiseLimits(cv::Size(2,2),0);
+    finder.setTolerances(3,1);
+
+    SubDetection::RectVector lines;
+
+    QCOMPARE(finder.find(maskFromString(mask),lines),found);
+
+    if (!found) return;
+
+    QCOMPARE(static_cast<int>(lines.size()),lineCount);
+    if (lineCount) QVERIFY(lines.front() == cv::Rect(firstLine.x(),firstLine.y(),firstLine.width(),firstLine.height()));
+}//projectionLineFinder
+
+//-------------------------
+
+void SubDetectionTest::detectorRuns()
+{
+    const cv::Size frameSize(96,64);
+
+    SubDetection::Detector componentDetector(detectorParameters(frameSize));
+    componentDetector.setMaskingMethod(SubDetection::Detector::MM_LOOKUP_TABLE);
+    componentDetector.setExtractionMethod(SubDetection::ContourManager::EM_COMPONENTS);
+
+    SubDetection::Detector runDetector(detectorParameters(frameSize));
+    runDetector.setMaskingMethod(SubDetection::Detector::MM_LOOKUP_TABLE);
+    runDetector.setExtractionMethod(SubDetection::ContourManager::EM_RUNS);
+
+    //Noise, a shape too big to be text and two shapes too few to make a line
+    cv::Mat frame = cv::Mat::zeros(frameSize,CV_8UC3);
+    frame.at<cv::Vec3b>(2,2) = cv::Vec3b(255,255,255);
+    frame(cv::Rect(4,8,30,30)).setTo(cv::Scalar::all(255));
+    frame(cv::Rect(50,20,6,8)).setTo(cv::Scalar::all(255));
+    frame(cv::Rect(60,20,6,8)).setTo(cv::Scalar::all(255));
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        QStringList componentLines;
+        QStringList runLines;
+
+        SubDetection::Detector::ReturnCode expected = pass ? SubDetection::Detector::RC_NO_CHANGE : SubDetection::Detector::RC_OK;
+
+        QCOMPARE(componentDetector.detect(frame,componentLines),expected);
+        QCOMPARE(runDetector.detect(frame,runLines),expected);
+
+        //Same text zone reference, found without writing any mask Mat
+        QVERIFY(runDetector.context().referenceTextZoneBits() == componentDetector.context().referenceTextZoneBits());
+        QVERIFY(runDetector.textZoneMat().empty());
+    }//for (int pass = 0; pass < 2; ++pass)
+
+    const SubDetection::DetectionContext::FilterStatistics & componentStatistics = componentDetector.filterStatistics();
+    const SubDetection::DetectionContext::FilterStatistics & runStatistics = runDetector.filterStatistics();
+
+    QCOMPARE(runStatistics.shapeCount,componentStatistics.shapeCount);
+    QCOMPARE(runStatistics.noiseCount,componentStatistics.noiseCount);
+    QCOMPARE(runStatistics.zoneCount,componentStatistics.zoneCount);
+    QCOMPARE(runStatistics.rejectedLineCount,componentStatistics.rejectedLineCount);
+    QCOMPARE(runStatistics.shapeCount,4);
+
+    SubDetection::PackedMask componentBits;
+    SubDetection::PackedMask runBits;
+    componentDetector.textZoneMask(frame,componentBits);
+    runDetector.textZoneMask(frame,runBits);
+    QVERIFY(runBits == componentBits);
+
+    //Lines are decoded into a reused mask: lines of previous change are cleared
+    QSharedPointer<SubDetection::OcrCache> pCache(new SubDetection::OcrCache);
+    runDetector.setOcrCache(pCache);
+
+    cv::Mat upperLine = cv::Mat::zeros(frameSize,CV_8UC3);
+    cacheTextLine(*pCache,upperLine,drawTextLine(upperLine,cv::Point(10,10),5),"five");
+
+    cv::Mat lowerLine = cv::Mat::zeros(frameSize,CV_8UC3);
+    cv::Rect lowerRect = drawTextLine(lowerLine,cv::Point(10,40),5);
+
+    QStringList subtitles;
+    QCOMPARE(runDetector.detect(upperLine,subtitles),SubDetection::Detector::RC_OK);
+    QCOMPARE(runDetector.detect(lowerLine,subtitles),SubDetection::Detector::RC_OK);
+    QCOMPARE(subtitles,QStringList() << "five" << "five");
+
+    const cv::Mat & threshMat = runDetector.thresholdedMat();
+    QCOMPARE(cv::countNonZero(threshMat),5 * 4 * 6);
+    QCOMPARE(cv::countNonZero(threshMat(lowerRect)),5 * 4 * 6);
+}//detectorRuns
+
+//-------------------------
+
+void SubDetectionTest::detectBatch()
+{
+    const cv::Size frameSize(96,48);
+
+    SubDetection::Detector detector(detectorParameters(frameSize));
+
+    //Lines are told apart by their character count
+    QSharedPointer<SubDetection::OcrCache> pCache(new SubDetection::OcrCache);
+    detector.setOcrCache(pCache);
+
+    cv::Mat empty = cv::Mat::zeros(frameSize,CV_8UC3);
+
+    cv::Mat five = empty.clone();
+    cacheTextLine(*pCache,five,drawTextLine(five,cv::Point(10,10),5),"five");
+
+    cv::Mat six = empty.clone();
+    cacheTextLine(*pCache,six,drawTextLine(six,cv::Point(10,30),6),"six");
+
+    cv::Mat fiveSeven = empty.clone();
+    drawTextLine(fiveSeven,cv::Point(10,10),5);
+    cacheTextLine(*pCache,fiveSeven,drawTextLine(fiveSeven,cv::Point(10,30),7),"seven");
+
+    std::vector<cv::Mat> images;
+    images.push_back(five);
+    images.push_back(six);
+    images.push_back(empty);
+    images.push_back(cv::Mat());//Invalid
+    images.push_back(fiveSeven);
+    images.push_back(five);
+
+    SubDetection::Detector::ResultVector results;
+    detector.detectBatch(images,results,3);
+
+    QCOMPARE(results.size(),images.size());
+
+    //Same as independent detections, in input order
+    for (std::vector<cv::Mat>::size_type i = 0; i < images.size(); ++i)
+    {
+        SubDetection::DetectionContext context;
+        QStringList subtitles;
+        SubDetection::RectVector rects;
+
+        SubDetection::Detector::ReturnCode result = detector.detect(images[i],subtitles,context);
+        if (result == SubDetection::Detector::RC_OK) context.textBoundingRects(rects);
+
+        QCOMPARE(results[i].result,result);
+        QCOMPARE(results[i].subtitles,subtitles);
+        QVERIFY(results[i].boundingRects == rects);
+    }//for (std::vector<cv::Mat>::size_type i = 0; i < images.size(); ++i)
+
+    QCOMPARE(results[0].subtitles,QStringList() << "five");
+    QCOMPARE(results[1].subtitles,QStringList() << "six");
+    QCOMPARE(results[2].result,SubDetection::Detector::RC_OK);
+    QVERIFY(results[2].subtitles.isEmpty());
+    QCOMPARE(results[3].result,SubDetection::Detector::RC_INVALID_INPUT_IMAGE);
+    QCOMPARE(results[4].subtitles,QStringList() << "five" << "seven");
+    QCOMPARE(results[5].subtitles,QStringList() << "five");
+    QCOMPARE(pCache->misses(),0);
+}//detectBatch
+
+//-------------------------
+
+void SubDetectionTest::incrementalRecognition()
+{
+    const cv::Size frameSize(96,48);
+
+    SubDetection::Detector detector(detectorParameters(frameSize));
+    detector.enableIncrementalRecognition(true);
+
+    //Lines are told apart by their character count
+    QSharedPointer<SubDetection::OcrCache> pCache(new SubDetection::OcrCache);
+    detector.setOcrCache(pCache);
+
+    cv::Mat first = cv::Mat::zeros(frameSize,CV_8UC3);
+    cacheTextLine(*pCache,first,drawTextLine(first,cv::Point(10,10),5),"five");
+    cacheTextLine(*pCache,first,drawTextLine(first,cv::Point(10,30),6),"six");
+
+    //Same first line, second one changes
+    cv::Mat second = cv::Mat::zeros(frameSize,CV_8UC3);
+    cv::Rect unchangedLine = drawTextLine(second,cv::Point(10,10),5);
+    cacheTextLine(*pCache,second,drawTextLine(second,cv::Point(10,30),7),"seven");
+
+    SubDetection::DetectionContext context;
+    QStringList subtitles;
+    QCOMPARE(detector.detect(first,subtitles,context),SubDetection::Detector::RC_OK);
+    QCOMPARE(subtitles,QStringList() << "five" << "six");
+    QCOMPARE(pCache->hits(),2);
+
+    //Unchanged line must keep its last text rather than go through cache or OCR
+    cacheTextLine(*pCache,second,unchangedLine,"FIVE");
+    pCache->resetCounters();
+
+    subtitles.clear();
+    QCOMPARE(detector.detect(second,subtitles,context),SubDetection::Detector::RC_OK);
+    QCOMPARE(subtitles,QStringList() << "five" << "seven");
+    QCOMPARE(pCache->hits(),1);
+    QCOMPARE(pCache->misses(),0);
+
+    //Without incremental recognition, every line is looked up
+    detector.enableIncrementalRecognition(false);
+    pCache->resetCounters();
+
+    SubDetection::DetectionContext otherContext;
+    subtitles.clear();
+    QCOMPARE(detector.detect(first,subtitles,otherContext),SubDetection::Detector::RC_OK);
+    subtitles.clear();
+    QCOMPARE(detector.detect(second,subtitles,otherContext),SubDetection::Detector::RC_OK);
+    QCOMPARE(subtitles,QStringList() << "FIVE" << "seven");
+    QCOMPARE(pCache->hits(),4);
+}//incrementalRecognition
+
+//-------------------------
+
+void SubDetectionTest::parallelRecognition()
+{
+    const cv::Size frameSize(320,200);
+
+    //Printed characters are about 12 pixels apart
+    SubDetection::Parameters params = detectorParameters(frameSize);
+    params.xTolerance = 20;
+    params.yTolerance = 6;
+
+    SubDetection::Detector detector(params);
+
+    SubDetection::Detector::OcrEnginePoolPtr pPool(new SubDetection::OcrEnginePool(QString(),"eng",0,4));
+    detector.setOcrEnginePool(pPool);
+
+    cv::Mat image = cv::Mat::zeros(frameSize,CV_8UC3);
+    const char * words[] = {"ORIGINAL", "SEQUENCE", "PARALLEL", "THREADED"};
+
+    for (int i = 0; i < 4; ++i)
+    {
+        cv::putText(image,words[i],cv::Point(20,40 + 40 * i),cv::FONT_HERSHEY_SIMPLEX,0.6,cv::Scalar::all(255),2);
+    }//for (int i = 0; i < 4; ++i)
+
+    QStringList serialSubtitles;
+    SubDetection::DetectionContext serialContext;
+    QCOMPARE(detector.detect(image,serialSubtitles,serialContext),SubDetection::Detector::RC_OK);
+    QCOMPARE(pPool->size(),1);
+
+    //Lines are told apart by their text
+    QVERIFY(serialSubtitles.size() > 2);
+    QStringList distinct = serialSubtitles;
+    QCOMPARE(distinct.removeDuplicates(),0);
+
+    detector.enableParallelRecognition(true,4);
+
+    QStringList parallelSubtitles;
+    SubDetection::DetectionContext parallelContext;
+    QCOMPARE(detector.detect(image,parallelSubtitles,parallelContext),SubDetection::Detector::RC_OK);
+    QVERIFY(pPool->size() > 1);
+
+    QCOMPARE(parallelSubtitles,serialSubtitles);
+}//parallelRecognition
+
+//-------------------------
+
+void SubDetectionTest::detectionPipeline()
+{
+    const cv::Size frameSize(64,48);
+
+    QSharedPointer<SubDetection::Parameters> pParams(new SubDetection::Parameters(detectorParameters(frameSize)));
+
+    SubDetection::Detector detector(pParams);
+    detector.setMaskingMethod(SubDetection::Detector::MM_LOOKUP_TABLE);
+    detector.setExtractionMethod(SubDetection::ContourManager::EM_RUNS);
+
+    SubDetection::DetectionPipeline pipeline(pParams,".","eng",2);
+    pipeline.setMaskingMethod(SubDetection::Detector::MM_LOOKUP_TABLE);
+    pipeline.setExtractionMethod(SubDetection::ContourManager::EM_RUNS);
+    pipeline.start();
+
+    //Empty, shape appearing, still there, gone. Shapes are too big to be text.
+    const int frameCount = 6;
+    const int shapeFrames[frameCount] = {0,0,1,1,0,1};
+
+    std::vector<cv::Mat> frames;
+    QList<SubDetection::Detector::ReturnCode> expected;
+
+    for (int i = 0; i < frameCount; ++i)
+    {
+        cv::Mat frame = cv::Mat::zeros(frameSize,CV_8UC3);
+        if (shapeFrames[i]) frame(cv::Rect(10,10,30,30)).setTo(cv::Scalar::all(255));
+        frames.push_back(frame);
+
+        QStringList subtitles;
+        expected.append(detector.detect(frame,subtitles));
+
+        pipeline.push(frame,i);
+    }//for (int i = 0; i < frameCount; ++i)
+
+    pipeline.finish();
+
+    QCOMPARE(expected.count(SubDetection::Detector::RC_OK),4);
+
+    SubDetection::DetectionPipeline::FramePtr pFrame;
+    int popped = 0;
+
+    while (pipeline.pop(pFrame))
+    {
+        QVERIFY(popped < frameCount);
+        QCOMPARE(pFrame->id,static_cast<qint64>(popped));
+        QCOMPARE(pFrame->result,expected[popped]);
+        QVERIFY(pFrame->subtitles.isEmpty());
+
+        ++popped;
+    }//while (pipeline.pop(pFrame))
+
+    QCOMPARE(popped,frameCount);
+}//detectionPipeline
+
+//-------------------------
+
+void SubDetectionTest::videoSubtitleExtractorProbe()
+{
+    const cv::Size frameSize(64,64);
+    const int frameCount = 9;
+    const int changeIndex = 5;
+
+    SubDetection::Detector detector(detectorParameters(frameSize));
+    detector.setChangeDetectionMethod(SubDetection::Detector::CDM_PACKED);
+    detector.setExtractionMethod(SubDetection::ContourManager::EM_COMPONENTS);
+    detector.setContourInput(SubDetection::ContourManager::IF_BINARY);
+
+    ProbingExtractor extractor(detector);
+
+    //A shape too big to be text appears at changeIndex. Each frame has its own noise pixel.
+    std::vector<cv::Mat> frames;
+
+    for (int i = 0; i < frameCount; ++i)
+    {
+        cv::Mat frame = cv::Mat::zeros(frameSize,CV_8UC3);
+        if (i >= changeIndex) frame(cv::Rect(8,8,40,40)).setTo(cv::Scalar::all(255));
+        frame.at<cv::Vec3b>(60,2 * i) = cv::Vec3b(255,255,255);
+
+        frames.push_back(frame);
+        extractor.addFrame(frame,i * 40);
+    }//for (int i = 0; i < frameCount; ++i)
+
+    SubDetection::PackedMask firstBits;
+    SubDetection::PackedMask changeBits;
+    SubDetection::PackedMask nextBits;
+    detector.textZoneMask(frames[0],firstBits);
+    detector.textZoneMask(frames[changeIndex],changeBits);
+    detector.textZoneMask(frames[changeIndex + 1],nextBits);
+
+    extractor.detectFirstFrame();
+
+    QCOMPARE(extractor.statistics().maskedFrameCount,1);
+    QVERIFY(extractor.referenceBits() == firstBits);
+
+    //Last frame, then frames 4, 6 and 5 are masked. Detecting frame 5 does not count it twice.
+    extractor.probe();
+
+    QCOMPARE(extractor.statistics().maskedFrameCount,5);
+    QCOMPARE(extractor.bufferSize(),1);
+    QVERIFY(extractor.referenceBits() == changeBits);
+    QVERIFY(extractor.referenceBits() != nextBits);
+}//videoSubtitleExtractorProbe
+
 //-------------------------
 /*
 void SubDetectionTest::cleanupTestCase()
@@ -49,6 +49,66 @@ private Q_SLOTS:
     void medianHsvList_data();
     void medianHsvList();
 
+    void hsvMaskTable_data();
+    void hsvMaskTable();
+
+    void packedMaskDifference_data();
+    void packedMaskDifference();
+
+    void ocrCache();
+
+    void ocrEnginePool();
+
+    void subtitleTimestamp_data();
+    void subtitleTimestamp();
+    void subtitleEvents();
+
+    void spscQueue();
+    void spscQueueThreads();
+
+    void componentLabeler_data();
+    void componentLabeler();
+
+    void componentLabelerBands_data();
+    void componentLabelerBands();
+
+    void tiledMasking_data();
+    void tiledMasking();
+
+    void componentLabelerIncremental();
+
+    void contourManagerBinaryInput();
+
+    void contourManagerNoiseLimits_data();
+    void contourManagerNoiseLimits();
+
+    void contourStore();
+
+    void childIndexTable();
+
+    void contourRasterizer_data();
+    void contourRasterizer();
+
+    void componentTableFilter();
+
+    void textLineGrouper_data();
+    void textLineGrouper();
+
+    void projectionLineFinder_data();
+    void projectionLineFinder();
+
+    void detectorRuns();
+
+    void detectBatch();
+
+    void incrementalRecognition();
+
+    void parallelRecognition();
+
+    void detectionPipeline();
+
+    void videoSubtitleExtractorProbe();
+
 //    void cleanupTestCase();
 };//SubDetectionTest
 